@@ -0,0 +1,126 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "graph/level.h"
+#include "graph/board.h"
+#include "graph/hbl.h"
+#include "graph/serialize.h"
+
+static Board *load_text(const char *level) {
+  FILE* levelfh = fopen(level, "r");
+  if (levelfh == NULL) {
+    perror("Could not open level");
+    return NULL;
+  }
+
+  SavedTile *map = NULL;
+  ConfigOption *cfg = NULL;
+  level_parse_file(levelfh, &map, &cfg);
+
+  fclose(levelfh);
+
+  if ((map == NULL) || (cfg == NULL)) {
+    fprintf(stderr, "Could not succesfully parse %s.\n", level);
+    free(map);
+    free(cfg);
+    return NULL;
+  }
+  Board *board = board_assemble_full(map, cfg);
+  for (size_t i = 0; map[i].path; i++)
+    free(map[i].path);
+  free(map);
+  free(cfg);
+  if (board == NULL)
+    fprintf(stderr, "Could not succesfully create board from %s.\n", level);
+  return board;
+}
+
+/* The name of level with its extension swapped for the other format's. */
+static char *converted_name(const char *level, int binary) {
+  const char *extension = binary ? TEXT_EXTENSION : HBL_EXTENSION;
+  const char *dot = strrchr(level, '.');
+  const char *slash = strrchr(level, '/');
+  size_t stem = (dot && (!slash || dot > slash)) ? (size_t) (dot - level)
+    : strlen(level);
+  char *name = malloc(stem + strlen(extension) + 1);
+  memcpy(name, level, stem);
+  strcpy(name + stem, extension);
+  return name;
+}
+
+static int convert_level(const char *level) {
+  int binary = hbl_is_binary(level);
+  Board *board = binary ? hbl_load(level) : load_text(level);
+  if (board == NULL) return 0;
+
+  char *name = converted_name(level, binary);
+  FILE *file = fopen(name, "w");
+  int converted = 0;
+  if (file == NULL) {
+    perror(name);
+  } else {
+    if (binary)
+      serialize_board(board, file);
+    else
+      serialize_board_binary(board, file);
+    if (fclose(file) != 0)
+      perror(name);
+    else {
+      printf(CONVERTED_TEXT, level, board->flat->num_tiles, name);
+      converted = 1;
+    }
+  }
+
+  free(name);
+  free_board(board);
+  return converted;
+}
+
+int main(int argc, char *argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "h")) != -1) {
+    switch (opt) {
+    case 'h':
+      printf(CONVERT_USAGE, argv[0]);
+      return 0;
+    default:
+      fprintf(stderr, CONVERT_USAGE, argv[0]);
+      return 2;
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, CONVERT_USAGE, argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  for (int i = optind; i < argc; i++)
+    if (!convert_level(argv[i]))
+      failed = 1;
+
+  return failed;
+}
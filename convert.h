@@ -0,0 +1,38 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN_CONVERT_H
+#define __HYPERBAN_CONVERT_H
+
+#define CONVERT_USAGE \
+"Usage: %s LEVEL...\n" \
+"Convert every LEVEL between text and binary.  A LEVEL ending in .hbl is\n" \
+"binary and is written out as text, with .txt in place of .hbl; any\n" \
+"other is text and is written out as binary, with .hbl in place of its\n" \
+"extension.\n" \
+"\n" \
+"  -h            show this help\n" \
+"\n" \
+"Exits with status 1 if any level could not be converted.\n"
+
+#define TEXT_EXTENSION ".txt"
+#define CONVERTED_TEXT "%s: %zu tiles written to %s\n"
+
+#endif /* __HYPERBAN_CONVERT_H */
@@ -0,0 +1,183 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "generate.h"
+#include "graph/board.h"
+#include "graph/generator.h"
+#include "graph/serialize.h"
+#include "solver/rating.h"
+#include "solver/workers.h"
+
+typedef struct {
+  const GeneratorParams *params;
+  const SolverParams *rating; /* NULL to leave levels unrated */
+  const char *prefix;
+  unsigned long long seed;
+  int width; /* of the numbers in the file names */
+  char *failed; /* one flag a thread, so no two threads write the same */
+} Batch;
+
+/* Make level i of the batch and write it out.  Levels only depend on their
+   seeds, so they can be made in any order. */
+static void generate_level(void *arg, size_t thread, size_t i) {
+  Batch *b = arg;
+  size_t length = strlen(b->prefix) + b->width + sizeof(".txt");
+  char *filename = malloc(length);
+  snprintf(filename, length, "%s%0*zu.txt", b->prefix, b->width, i);
+
+  Board *board = generate_board_seeded(b->params, b->seed + i);
+  if (board == NULL) {
+    fprintf(stderr, NO_ROOM_TEXT, filename);
+    b->failed[thread] = 1;
+    free(filename);
+    return;
+  }
+  FILE *file = fopen(filename, "w");
+  if (file == NULL) {
+    perror(filename);
+    b->failed[thread] = 1;
+    free_board(board);
+    free(filename);
+    return;
+  }
+  if (b->rating) {
+    Rating rating;
+    rate_board(board, b->rating, &rating);
+    if (rating.status == SOLVER_SOLVED)
+      board->difficulty = rating.difficulty;
+    else
+      fprintf(stderr, UNRATED_TEXT, filename);
+  }
+  fprintf(file, SEED_COMMENT, b->seed + i);
+  serialize_board(board, file);
+  if (fclose(file) != 0) {
+    perror(filename);
+    b->failed[thread] = 1;
+  }
+  free_board(board);
+  free(filename);
+}
+
+int main(int argc, char *argv[]) {
+  GeneratorParams params = {
+    GENERATOR_DEFAULT_MIN_SIZE,
+    GENERATOR_DEFAULT_SIZE_RANGE,
+    GENERATOR_DEFAULT_MAX_DEAD_ENDS,
+    GENERATOR_DEFAULT_NUM_GOALS,
+    GENERATOR_DEFAULT_NUM_PULLS
+  };
+  SolverParams rating = {
+    RATING_DEFAULT_MAX_NODES,
+    RATING_DEFAULT_TABLE_SIZE,
+    SOLVER_ASTAR,
+    1 /* levels are already made side by side */
+  };
+  size_t count = 1, threads = 1;
+  unsigned long long seed = time(NULL);
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:j:z:g:e:p:r:h")) != -1) {
+    switch (opt) {
+    case 'n':
+      if (!sscanf(optarg, "%zu", &count)) {
+        fprintf(stderr, "Could not parse count!\n");
+        return 2;
+      }
+      break;
+    case 's':
+      if (!sscanf(optarg, "%llu", &seed)) {
+        fprintf(stderr, "Could not parse seed!\n");
+        return 2;
+      }
+      break;
+    case 'j':
+      if (!sscanf(optarg, "%zu", &threads) || threads == 0) {
+        fprintf(stderr, "Could not parse threads!\n");
+        return 2;
+      }
+      break;
+    case 'z':
+      if (!sscanf(optarg, "%zu", &params.min_size) || params.min_size == 0) {
+        fprintf(stderr, "Could not parse room size!\n");
+        return 2;
+      }
+      break;
+    case 'g':
+      if (!sscanf(optarg, "%zu", &params.num_goals)) {
+        fprintf(stderr, "Could not parse goals!\n");
+        return 2;
+      }
+      break;
+    case 'e':
+      if (!sscanf(optarg, "%zu", &params.max_dead_ends)) {
+        fprintf(stderr, "Could not parse dead ends!\n");
+        return 2;
+      }
+      break;
+    case 'p':
+      if (!sscanf(optarg, "%zu", &params.num_pulls)) {
+        fprintf(stderr, "Could not parse pulls!\n");
+        return 2;
+      }
+      break;
+    case 'r':
+      if (!sscanf(optarg, "%zu", &rating.max_nodes)) {
+        fprintf(stderr, "Could not parse rating nodes!\n");
+        return 2;
+      }
+      break;
+    case 'h':
+      printf(GENERATE_USAGE, argv[0]);
+      return 0;
+    default:
+      fprintf(stderr, GENERATE_USAGE, argv[0]);
+      return 2;
+    }
+  }
+
+  if (optind + 1 != argc) {
+    fprintf(stderr, GENERATE_USAGE, argv[0]);
+    return 2;
+  }
+
+  Batch batch;
+  batch.params = &params;
+  batch.rating = rating.max_nodes ? &rating : NULL;
+  batch.prefix = argv[optind];
+  batch.seed = seed;
+  batch.width = snprintf(NULL, 0, "%zu", count ? count - 1 : 0);
+  batch.failed = calloc(threads, sizeof(char));
+
+  Workers *pool = new_workers(threads);
+  workers_for(pool, count, generate_level, &batch);
+  free_workers(pool);
+
+  int failed = 0;
+  for (size_t t = 0; t < threads; t++)
+    failed |= batch.failed[t];
+  free(batch.failed);
+  return failed;
+}
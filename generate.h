@@ -0,0 +1,48 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN_GENERATE_H
+#define __HYPERBAN_GENERATE_H
+
+#define GENERATE_USAGE \
+"Usage: %s [-n COUNT] [-s SEED] [-j THREADS] [-z SIZE] [-g GOALS]\n" \
+"       [-e DEAD_ENDS] [-p PULLS] [-r MAX_NODES] PREFIX\n" \
+"Generate random levels, each to a file named PREFIX, its number and .txt.\n" \
+"\n" \
+"  -n COUNT      how many levels to make (default 1)\n" \
+"  -s SEED       what to make them from (default the time); level i is\n" \
+"                made from SEED + i, whatever the number of threads\n" \
+"  -j THREADS    generate with this many threads (default 1)\n" \
+"  -z SIZE       the least number of floor tiles in a room (default 10)\n" \
+"  -g GOALS      how many targets and boxes (default 2)\n" \
+"  -e DEAD_ENDS  how many dead ends a room may have (default 0); a level\n" \
+"                with no such room in ten million tries is not written\n" \
+"  -p PULLS      pulls played backwards from the solution to place the\n" \
+"                boxes (default 200)\n" \
+"  -r MAX_NODES  rate each level's difficulty by solving it, giving up\n" \
+"                after expanding this many states (default 100000);\n" \
+"                0 leaves the levels unrated\n" \
+"  -h            show this help\n"
+
+#define SEED_COMMENT "# seed %llu\n"
+#define UNRATED_TEXT "%s: not solved in time, left unrated\n"
+#define NO_ROOM_TEXT "%s: no room with few enough dead ends, not written\n"
+
+#endif /* __HYPERBAN_GENERATE_H */
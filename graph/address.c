@@ -0,0 +1,363 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "address.h"
+#include "zobrist.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_ENTRY UINT32_MAX
+
+typedef struct {
+  uint64_t key;
+  Golden center[3];
+  Isometry node; /* the node the normal form ends on */
+  uint32_t parent;
+  uint32_t length; /* in steps */
+  int turn;
+} AddressEntry;
+
+struct address_book_t {
+  AddressEntry *entries;
+  size_t num_entries;
+  size_t entries_size;
+  uint32_t *table; /* open addressing on key; NO_ENTRY is empty */
+  size_t table_size;
+};
+
+/* Coefficients are kept within this bound, which leaves room to compare
+   them exactly in 128 bits. */
+#define GOLDEN_LIMIT ((int64_t) 1 << 60)
+
+static int golden_in_range (Golden x)
+{
+  return x.a <= GOLDEN_LIMIT && x.a >= -GOLDEN_LIMIT
+    && x.b <= GOLDEN_LIMIT && x.b >= -GOLDEN_LIMIT;
+}
+
+static int golden_add (Golden x, Golden y, Golden *out)
+{
+  out->a = x.a + y.a;
+  out->b = x.b + y.b;
+  return golden_in_range(*out);
+}
+
+static void golden_neg (Golden x, Golden *out)
+{
+  out->a = -x.a;
+  out->b = -x.b;
+}
+
+/* (a + b phi) phi = b + (a + b) phi */
+static int golden_phi (Golden x, Golden *out)
+{
+  Golden y = { x.b, x.a + x.b };
+  *out = y;
+  return golden_in_range(y);
+}
+
+/* The sign of x - y.  Twice a + b phi is (2a + b) + b sqrt(5). */
+static int golden_compare (Golden x, Golden y)
+{
+  __int128 a = (__int128) x.a - y.a;
+  __int128 b = (__int128) x.b - y.b;
+  __int128 r = 2 * a + b;
+  if (r >= 0 && b >= 0)
+    return r || b;
+  if (r <= 0 && b <= 0)
+    return -1;
+  /* |r| and |b| are under 2^63, so their squares fit */
+  __int128 d = r * r - 5 * b * b;
+  if (r > 0)
+    return d > 0 ? 1 : -1;
+  return d < 0 ? 1 : -1;
+}
+
+static int golden_equal (Golden x, Golden y)
+{
+  return x.a == y.a && x.b == y.b;
+}
+
+/* node = node * rotate_r: the old second column, negated, becomes the
+   first. */
+static void address_rotate (Isometry *node)
+{
+  for (int i = 0; i < 3; i++)
+    {
+      Golden c = node->m[i][0];
+      golden_neg(node->m[i][1], &node->m[i][0]);
+      node->m[i][1] = c;
+    }
+}
+
+/* node = node * F, where F = adjacent * rotate_r^2 is the translation
+     1 0   0
+     0 phi phi
+     0 1   phi
+   one tile along the second axis. */
+static int address_forward (Isometry *node)
+{
+  for (int i = 0; i < 3; i++)
+    {
+      Golden y = node->m[i][1], z = node->m[i][2], t;
+      if (!golden_phi(y, &t) || !golden_add(t, z, &node->m[i][1]))
+        return 0;
+      if (!golden_add(y, z, &t) || !golden_phi(t, &node->m[i][2]))
+        return 0;
+    }
+  return 1;
+}
+
+/* node = node * rotate_r^turn * F */
+static int address_step (Isometry *node, int turn)
+{
+  for (int i = 0; i < turn; i++)
+    address_rotate(node);
+  return address_forward(node);
+}
+
+void address_root (Isometry *node)
+{
+  memset(node, 0, sizeof(Isometry));
+  for (int i = 0; i < 3; i++)
+    node->m[i][i].a = 1;
+}
+
+int address_walk (Isometry *node, const char *path)
+{
+  for (; *path; path++)
+    {
+      int turns = 0;
+      switch (*path)
+        {
+        case 'L': case 'l':
+          turns++;
+          /* Fall through */
+        case 'B': case 'b':
+          turns++;
+          /* Fall through */
+        case 'R': case 'r':
+          turns++;
+          for (int i = 0; i < turns; i++)
+            address_rotate(node);
+          break;
+        case 'F': case 'f':
+          if (!address_forward(node))
+            return 0;
+          break;
+        }
+    }
+  return 1;
+}
+
+static uint64_t address_center_key (const Golden *center)
+{
+  uint64_t key = 0;
+  for (int i = 0; i < 3; i++)
+    {
+      key = zobrist_mix(key ^ (uint64_t) center[i].a);
+      key = zobrist_mix(key ^ (uint64_t) center[i].b);
+    }
+  return key;
+}
+
+static void address_center (const Isometry *node, Golden *center)
+{
+  for (int i = 0; i < 3; i++)
+    center[i] = node->m[i][2];
+}
+
+uint64_t address_key (const Isometry *node)
+{
+  Golden center[3];
+  address_center(node, center);
+  return address_center_key(center);
+}
+
+int address_path_key (const char *path, uint64_t *key)
+{
+  Isometry node;
+  address_root(&node);
+  if (!address_walk(&node, path))
+    return 0;
+  *key = address_key(&node);
+  return 1;
+}
+
+AddressBook *new_address_book (void)
+{
+  AddressBook *book = malloc(sizeof(AddressBook));
+  book->entries_size = 64;
+  book->num_entries = 0;
+  book->entries = malloc(book->entries_size * sizeof(AddressEntry));
+  book->table_size = 2 * book->entries_size;
+  book->table = malloc(book->table_size * sizeof(uint32_t));
+  memset(book->table, 0xff, book->table_size * sizeof(uint32_t));
+  return book;
+}
+
+void free_address_book (AddressBook *book)
+{
+  free(book->entries);
+  free(book->table);
+  free(book);
+}
+
+static uint32_t *address_slot (AddressBook *book, uint64_t key,
+                               const Golden *center)
+{
+  size_t mask = book->table_size - 1;
+  for (size_t i = key & mask;; i = (i + 1) & mask)
+    {
+      uint32_t e = book->table[i];
+      if (e == NO_ENTRY)
+        return &book->table[i];
+      AddressEntry *entry = &book->entries[e];
+      if (entry->key == key && golden_equal(entry->center[0], center[0])
+          && golden_equal(entry->center[1], center[1])
+          && golden_equal(entry->center[2], center[2]))
+        return &book->table[i];
+    }
+}
+
+static uint32_t address_insert (AddressBook *book, AddressEntry *entry)
+{
+  if (book->num_entries == book->entries_size)
+    {
+      book->entries_size *= 2;
+      book->entries = realloc(book->entries,
+                              book->entries_size * sizeof(AddressEntry));
+      /* keep the table at most half full */
+      free(book->table);
+      book->table_size *= 2;
+      book->table = malloc(book->table_size * sizeof(uint32_t));
+      memset(book->table, 0xff, book->table_size * sizeof(uint32_t));
+      for (uint32_t e = 0; e < book->num_entries; e++)
+        *address_slot(book, book->entries[e].key, book->entries[e].center) = e;
+    }
+  uint32_t e = book->num_entries++;
+  book->entries[e] = *entry;
+  *address_slot(book, entry->key, entry->center) = e;
+  return e;
+}
+
+/* Whether the normal form of entry x comes before that of entry y, which
+   must be as long.  They share everything up to their last common ancestor,
+   and differ in the turn taken there. */
+static int address_less (AddressBook *book, uint32_t x, uint32_t y)
+{
+  while (book->entries[x].parent != book->entries[y].parent)
+    {
+      x = book->entries[x].parent;
+      y = book->entries[y].parent;
+    }
+  return book->entries[x].turn < book->entries[y].turn;
+}
+
+/* Find or make the entry for the tile node is on.
+
+   A neighbour one step nearer the root in the tiling is also nearer in the
+   plane, so the normal form's last step comes from one of the neighbours
+   with a smaller last coordinate.  Recursing on those only ever climbs
+   towards the root, and the memo keeps each tile to one visit. */
+static uint32_t address_resolve (AddressBook *book, const Isometry *node)
+{
+  AddressEntry entry;
+  address_center(node, entry.center);
+  entry.key = address_center_key(entry.center);
+
+  uint32_t e = *address_slot(book, entry.key, entry.center);
+  if (e != NO_ENTRY)
+    return e;
+
+  entry.parent = NO_ENTRY;
+  entry.length = 0;
+  entry.turn = 0;
+  address_root(&entry.node);
+  if (golden_equal(entry.center[0], entry.node.m[0][2])
+      && golden_equal(entry.center[1], entry.node.m[1][2])
+      && golden_equal(entry.center[2], entry.node.m[2][2]))
+    return address_insert(book, &entry);
+
+  Isometry n = *node;
+  for (int d = 0; d < 4; d++)
+    {
+      Isometry neighbor = n;
+      if (!address_forward(&neighbor))
+        return NO_ENTRY;
+      if (golden_compare(neighbor.m[2][2], entry.center[2]) < 0)
+        {
+          uint32_t p = address_resolve(book, &neighbor);
+          if (p == NO_ENTRY)
+            return NO_ENTRY;
+          if (entry.parent == NO_ENTRY
+              || book->entries[p].length < book->entries[entry.parent].length
+              || (book->entries[p].length
+                  == book->entries[entry.parent].length
+                  && address_less(book, p, entry.parent)))
+            entry.parent = p;
+        }
+      address_rotate(&n);
+    }
+  if (entry.parent == NO_ENTRY)
+    return NO_ENTRY;
+
+  /* Which way the parent's node has to turn to reach us */
+  AddressEntry *parent = &book->entries[entry.parent];
+  entry.length = parent->length + 1;
+  for (entry.turn = 0; entry.turn < 4; entry.turn++)
+    {
+      entry.node = parent->node;
+      if (!address_step(&entry.node, entry.turn))
+        return NO_ENTRY;
+      if (golden_equal(entry.center[0], entry.node.m[0][2])
+          && golden_equal(entry.center[1], entry.node.m[1][2])
+          && golden_equal(entry.center[2], entry.node.m[2][2]))
+        return address_insert(book, &entry);
+    }
+  return NO_ENTRY;
+}
+
+char *address_normal_form (AddressBook *book, const char *path)
+{
+  Isometry node;
+  address_root(&node);
+  if (!address_walk(&node, path))
+    return NULL;
+  uint32_t e = address_resolve(book, &node);
+  if (e == NO_ENTRY)
+    return NULL;
+
+  size_t n = 0;
+  for (uint32_t i = e; book->entries[i].parent != NO_ENTRY;
+       i = book->entries[i].parent)
+    n += book->entries[i].turn ? 2 : 1;
+  char *word = malloc(n + 1);
+  word[n] = '\0';
+  for (uint32_t i = e; book->entries[i].parent != NO_ENTRY;
+       i = book->entries[i].parent)
+    {
+      word[--n] = 'F';
+      if (book->entries[i].turn)
+        word[--n] = " RBL"[book->entries[i].turn];
+    }
+  return word;
+}
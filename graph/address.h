@@ -0,0 +1,79 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__ADDRESS_H
+#define __HYPERBAN__ADDRESS_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* Tiles addressed without a pointer graph.
+
+   The nodes of the {4,5} tiling are the elements of the group generated by
+   rotate_r and adjacent, which acts faithfully on the hyperbolic plane.  In
+   a suitably scaled hyperboloid model both generators have entries in
+   Z[phi], phi the golden ratio, so every node is an exact integer matrix and
+   its tile is the image of the origin: the matrix's last column.  Walking a
+   path string is a product of generators; two paths reach the same tile
+   exactly when their columns agree.
+
+   Coefficients grow about threefold with each step away from the root, so
+   exact arithmetic overflows some forty steps from the root.  Functions
+   that could overflow report it rather than answer wrongly. */
+
+/* a + b * phi */
+typedef struct {
+  int64_t a, b;
+} Golden;
+
+typedef struct {
+  Golden m[3][3];
+} Isometry;
+
+/* Memo of normal forms already worked out; reusing one across calls makes
+   addressing every tile of a level cost little more than addressing the
+   farthest. */
+typedef struct address_book_t AddressBook;
+
+/* The root node, facing 0. */
+void address_root (Isometry *node);
+
+/* Follow path from node as build_add_node does.  Returns 0 on overflow,
+   leaving node undefined. */
+int address_walk (Isometry *node, const char *path);
+
+/* A key for the tile node is on, whatever its orientation. */
+uint64_t address_key (const Isometry *node);
+
+/* address_key of the tile path reaches from the root.  Returns 0 on
+   overflow. */
+int address_path_key (const char *path, uint64_t *key);
+
+AddressBook *new_address_book (void);
+void free_address_book (AddressBook *book);
+
+/* The canonical path to the tile path reaches from the root: the shortlex
+   least word over the steps F, RF, BF, LF (in that order) that ends on the
+   same tile.  It is as short as any path there.  The result is malloced;
+   NULL on overflow. */
+char *address_normal_form (AddressBook *book, const char *path);
+
+#endif /* __HYPERBAN__ADDRESS_H */
@@ -0,0 +1,94 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+
+struct arena_chunk_t {
+  struct arena_chunk_t *next;
+  size_t size;
+  size_t used;
+};
+
+#define ROUND_UP(n) (((n) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+#define CHUNK_DATA(c) ((char *) (c) + ROUND_UP(sizeof(struct arena_chunk_t)))
+
+static struct arena_chunk_t *new_chunk (size_t size)
+{
+  struct arena_chunk_t *c =
+    malloc(ROUND_UP(sizeof(struct arena_chunk_t)) + size);
+  c->next = NULL;
+  c->size = size;
+  c->used = 0;
+  return c;
+}
+
+Arena *new_arena (void)
+{
+  Arena *arena = malloc(sizeof(Arena));
+  arena->chunks = new_chunk(ARENA_MIN_CHUNK);
+  arena->num_tiles = 0;
+  return arena;
+}
+
+void *arena_alloc (Arena *arena, size_t size)
+{
+  size = ROUND_UP(size);
+  struct arena_chunk_t *c = arena->chunks;
+  if (c->used + size > c->size)
+    {
+      /* Chunks double in size so the list stays short. */
+      size_t chunk_size = c->size * 2;
+      if (chunk_size > ARENA_MAX_CHUNK)
+        chunk_size = ARENA_MAX_CHUNK;
+      if (chunk_size < size)
+        chunk_size = size;
+      c = new_chunk(chunk_size);
+      c->next = arena->chunks;
+      arena->chunks = c;
+    }
+  void *returnee = CHUNK_DATA(c) + c->used;
+  c->used += size;
+  return returnee;
+}
+
+void arena_reset (Arena *arena)
+{
+  /* Keep the newest chunk, which is the largest short of oversized
+     allocations. */
+  struct arena_chunk_t *c = arena->chunks->next;
+  while (c)
+    {
+      struct arena_chunk_t *next = c->next;
+      free(c);
+      c = next;
+    }
+  arena->chunks->next = NULL;
+  arena->chunks->used = 0;
+  arena->num_tiles = 0;
+}
+
+void free_arena (Arena *arena)
+{
+  arena_reset(arena);
+  free(arena->chunks);
+  free(arena);
+}
@@ -0,0 +1,40 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__ARENA_H
+#define __HYPERBAN__ARENA_H
+
+#include "types.h"
+
+/* A bump allocator.  Everything allocated from an arena is freed together
+   by free_arena, or made reusable by arena_reset; there is no way to free
+   one allocation on its own. */
+
+Arena *new_arena (void);
+void *arena_alloc (Arena *arena, size_t size);
+/* Forget every allocation but keep the largest chunk for reuse. */
+void arena_reset (Arena *arena);
+void free_arena (Arena *arena);
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_CHUNK (64 * 1024)
+#define ARENA_MAX_CHUNK (4 * 1024 * 1024)
+
+#endif /* __HYPERBAN__ARENA_H */
@@ -19,16 +19,140 @@
  */
 
 #include "audit.h"
+#include "address.h"
+#include "flat.h"
 #include "types.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+  uint64_t key;
+  size_t tile;
+} KeyedTile;
+
+static int compare_keyed_tiles (const void *a, const void *b)
+{
+  const KeyedTile *x = a, *y = b;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : 1;
+  return x->tile < y->tile ? -1 : x->tile > y->tile;
+}
+
+/* A tile may be listed more than once, as long as every listing says the
+   same thing about it; otherwise which one wins depends on the order they
+   are built in. */
 int audit_level (SavedTile *tiles, ConfigOption *options)
 {
-  /* placeholder function */
-  return 1;
+  size_t n = 0;
+  while (tiles[n].path)
+    n++;
+
+  KeyedTile *keyed = malloc((n + 1) * sizeof(KeyedTile));
+  size_t m = 0;
+  for (size_t i = 0; i < n; i++)
+    if (address_path_key(tiles[i].path, &keyed[m].key))
+      keyed[m++].tile = i; /* too far out to address; let it through */
+  qsort(keyed, m, sizeof(KeyedTile), compare_keyed_tiles);
+
+  int ok = 1;
+  for (size_t i = 1; i < m; i++)
+    {
+      SavedTile *a = &tiles[keyed[i - 1].tile], *b = &tiles[keyed[i].tile];
+      if (keyed[i - 1].key == keyed[i].key
+          && (a->tile_type != b->tile_type || a->agent != b->agent))
+        {
+          fprintf(stderr, "Paths %s and %s lead to the same tile.\n",
+                  a->path, b->path);
+          ok = 0;
+        }
+    }
+
+  free(keyed);
+  return ok;
 }
 
+/* Pull a lone box out from the tiles already in queue[0, tail), whose
+   distances are set, filling in dist for every tile it reaches.  Pulling
+   a box from tile t onto its neighbour s takes a free tile beyond s, on
+   the side away from t, for the player to back onto. */
+static void pull_search (const FlatGraph *f, uint32_t *dist, uint32_t *queue,
+                         size_t tail)
+{
+  size_t head = 0;
+  while (head < tail)
+    {
+      uint32_t t = queue[head++];
+      for (int d = 0; d < 4; d++)
+        {
+          uint32_t s = f->neighbor[4 * t + d];
+          if (s == FLAT_NONE || f->tile_type[FLAT_TILE(s)] == TILE_TYPE_WALL)
+            continue;
+          /* s faces back towards t, so the far side is opposite */
+          uint32_t beyond = f->neighbor[(s & ~3u) | ((s + 2) & 3)];
+          if (beyond == FLAT_NONE
+              || f->tile_type[FLAT_TILE(beyond)] == TILE_TYPE_WALL)
+            continue;
+          uint32_t u = FLAT_TILE(s);
+          if (dist[u] != UINT32_MAX)
+            continue;
+          dist[u] = dist[t] + 1;
+          queue[tail++] = u;
+        }
+    }
+}
+
+uint32_t *audit_pull_distances (const FlatGraph *f)
+{
+  uint32_t *dist = malloc(f->num_tiles * sizeof(uint32_t));
+  uint32_t *queue = malloc(f->num_tiles * sizeof(uint32_t));
+  size_t tail = 0;
+  for (uint32_t t = 0; t < f->num_tiles; t++)
+    {
+      dist[t] = UINT32_MAX;
+      if (f->tile_type[t] == TILE_TYPE_TARGET)
+        {
+          dist[t] = 0;
+          queue[tail++] = t;
+        }
+    }
+  pull_search(f, dist, queue, tail);
+  free(queue);
+  return dist;
+}
+
+void audit_pull_distances_from (const FlatGraph *f, uint32_t target,
+                                uint32_t *dist, uint32_t *queue)
+{
+  for (uint32_t t = 0; t < f->num_tiles; t++)
+    dist[t] = UINT32_MAX;
+  dist[target] = 0;
+  queue[0] = target;
+  pull_search(f, dist, queue, 1);
+}
+
+/* A box can reach a target from exactly the tiles it can be pulled to from
+   one, ignoring every other box.  Everything else that isn't a wall is
+   dead; walls can't hold a box at all, so they are not counted. */
 int audit_board (Board *board)
 {
-  /* placeholder function */
+  FlatGraph *f = board->flat;
+  uint32_t *dist = audit_pull_distances(f);
+  uint64_t *dead = calloc((f->num_tiles + 63) / 64, sizeof(uint64_t));
+  for (uint32_t t = 0; t < f->num_tiles; t++)
+    if (f->tile_type[t] != TILE_TYPE_WALL && dist[t] == UINT32_MAX)
+      dead[t / 64] |= 1ULL << (t % 64);
+  free(dist);
+  free(board->dead);
+  board->dead = dead;
   return 1;
 }
+
+int audit_board_stuck (Board *board)
+{
+  FlatGraph *f = board->flat;
+  for (uint32_t t = 0; t < f->num_tiles; t++)
+    if (f->agent[t] == AGENT_BOX && audit_is_dead(board, t))
+      return 1;
+  return 0;
+}
@@ -24,6 +24,28 @@
 #include "types.h"
 
 int audit_level (SavedTile *tiles, ConfigOption *options);
+
+/* Check a compiled board, and work out board->dead for it. */
 int audit_board (Board *board);
 
+/* How many pushes a box on each flat tile is from the nearest target, with
+   the board to itself, or UINT32_MAX where it can never reach one.  The
+   caller frees the array.  A box on a tile at UINT32_MAX is dead. */
+uint32_t *audit_pull_distances (const FlatGraph *f);
+
+/* The same from the one target, into dist, with queue as scratch; both
+   hold a tile each. */
+void audit_pull_distances_from (const FlatGraph *f, uint32_t target,
+                                uint32_t *dist, uint32_t *queue);
+
+/* Whether a box on flat tile t can never be pushed onto a target. */
+static inline int audit_is_dead (const Board *board, uint32_t t)
+{
+  return (board->dead[t / 64] >> (t % 64)) & 1;
+}
+
+/* Whether any box is on a dead tile, so the level can't be finished from
+   here. */
+int audit_board_stuck (Board *board);
+
 #endif /* __HYPERBAN__AUDIT_H */
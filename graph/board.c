@@ -20,9 +20,13 @@
 
 #include "board.h"
 #include "types.h"
+#include "arena.h"
 #include "audit.h"
 #include "build.h"
 #include "graph.h"
+#include "flat.h"
+#include "sokoban.h"
+#include "zobrist.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -100,15 +104,18 @@ static int board_process_config (Board *board, ConfigOption *option)
   return RETURN_SUCCESS;
 }
 
-Board *board_assemble (Graph *graph, SavedTile *tiles, ConfigOption *options)
+Board *board_assemble (Arena *arena, Graph *graph, SavedTile *tiles,
+                       ConfigOption *options)
 {
   Board *board = calloc(1, sizeof(Board));
 
+  board->arena = arena;
   board->graph = graph;
   board->unsolved = 0;
 
   /* Set currently run moves to 0 */
   board->number_moves = 0;
+  board->moves_redo = 0;
   board->moves_length = 4;
   board->moves = calloc(board->moves_length, sizeof(char));
 
@@ -126,6 +133,9 @@ Board *board_assemble (Graph *graph, SavedTile *tiles, ConfigOption *options)
         case RETURN_FAILURE:
         default:
           fprintf(stderr, "Adding config option failed.\n");
+          free_arena(arena);
+          free(board->moves);
+          free(board);
           return NULL;
         case RETURN_SUCCESS:
           break; /* continue iterating */
@@ -135,25 +145,74 @@ Board *board_assemble (Graph *graph, SavedTile *tiles, ConfigOption *options)
         }
     }
 
+  /* startpos may have moved the player, so compile last */
+  if (!board_compile(board))
+    {
+      free_board(board);
+      return NULL;
+    }
+
   return board;
 }
 
+int board_compile (Board *board)
+{
+  if (board->flat)
+    free_flat(board->flat);
+  board->flat = flat_compile(board->graph);
+  board->player = FLAT_ENTRY(0, 0); /* graph is always the root */
+  board->hash = zobrist_board(board);
+  return audit_board(board);
+}
+
+size_t board_replay (Board *board, const char *lurd, size_t n)
+{
+  FlatGraph *f = board->flat;
+  size_t done = replay_flat_moves(f, f->agent, &(board->player),
+                                  &(board->unsolved), &(board->hash), lurd, n);
+
+  /* Record the moves all at once; they are already spelled the way
+     perform_move would have recorded them. */
+  board->number_moves += done;
+  if (board->moves)
+    {
+      size_t length = board->number_moves - done;
+      while (board->moves_length < length + done)
+        board->moves_length *= 2;
+      board->moves = realloc(board->moves, board->moves_length);
+      memcpy(board->moves + length, lurd, done);
+      board->moves_redo = board->number_moves;
+    }
+
+  /* Bring the pointer graph up to date once, rather than after every push */
+  if (done)
+    {
+      for (size_t i = 0; i < f->num_tiles; i++)
+        f->nodes[i]->tile->agent = f->agent[i];
+      board->graph = flat_node(f, board->player);
+    }
+
+  return done;
+}
+
 Board *board_assemble_full (SavedTile *tiles, ConfigOption *options)
 {
   if (!audit_level(tiles, options))
     return NULL;
-  Graph *graph = build_graph(tiles);
-  Board *board = board_assemble(graph, tiles, options);
-  if (!audit_board(board))
-    return NULL;
+  Arena *arena = new_arena();
+  Graph *graph = build_graph(arena, tiles);
+  Board *board = board_assemble(arena, graph, tiles, options);
 
   return board;
 }
 
 void free_board (Board *b)
 {
-  if (b->graph)
-    free_graph(b->graph);
+  if (b->flat)
+    free_flat(b->flat);
+  free(b->dead);
+  if (b->arena)
+    free_arena(b->arena);
   if (b->moves)
     free(b->moves);
   if (b->level_title)
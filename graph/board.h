@@ -21,10 +21,24 @@
 #ifndef __HYPERBAN__BOARD_H
 #define __HYPERBAN__BOARD_H
 
+#include <stddef.h>
+
 #include "types.h"
 
-Board *board_assemble (Graph *graph, SavedTile *tiles, ConfigOption *options);
+/* board takes ownership of arena, which must hold graph. */
+Board *board_assemble (Arena *arena, Graph *graph, SavedTile *tiles,
+                       ConfigOption *options);
 Board *board_assemble_full (SavedTile *tiles, ConfigOption *options);
 void free_board (Board *b);
 
+/* Rebuild board->flat from board->graph, and audit the result.  Anything
+   that edits the pointer graph directly must call this before the next
+   move.  Returns 0 if the audit fails. */
+int board_compile (Board *board);
+
+/* Make the n moves in lurd, as perform_move would, up to the first that is
+   illegal or has the wrong case for whether it pushes.  Returns how many
+   were made; board->unsolved is 0 if they solved the level. */
+size_t board_replay (Board *board, const char *lurd, size_t n);
+
 #endif /* __HYPERBAN__BOARD_H */
@@ -20,32 +20,37 @@
 
 #include "types.h"
 #include "build.h"
-#include <malloc.h>
 
-Graph *build_initial_node (void)
+#include <stdlib.h>
+#include <string.h>
+
+/* A tile and its four nodes are allocated together. */
+typedef struct {
+  Graph nodes[4];
+  Tile tile;
+} TileBlock;
+
+Graph *build_initial_node (Arena *arena)
 {
-  Tile *t = malloc(sizeof(Tile));
+  TileBlock *block = arena_alloc(arena, sizeof(TileBlock));
+  Tile *t = &(block->tile);
 
   /* Set the Tile to the DEFAULT VALUES */
   t->tile_type = TILE_TYPE_DEFAULT;
   t->agent = AGENT_DEFAULT;
-  t->search_flag = 0;
+  t->index = arena->num_tiles++;
 
-  Graph *nodes[4];
-  for (size_t i = 0; i < 4; i++)
-    {
-      nodes[i] = malloc(sizeof(Graph));
-    }
+  Graph *nodes = block->nodes;
   for (size_t i = 0; i < 4; i++)
     {
-      nodes[i]->tile = t;
-      nodes[i]->rotate_r = nodes[(i + 1) % 4];
-      nodes[i]->adjacent = NULL;
+      nodes[i].tile = t;
+      nodes[i].rotate_r = &(nodes[(i + 1) % 4]);
+      nodes[i].adjacent = NULL;
     }
-  return nodes[0];
+  return &(nodes[0]);
 }
 
-static void build_enforce_convexity_left (Graph *g)
+static void build_enforce_convexity_left (Arena *arena, Graph *g)
 {
   if (!g)
     return; /* Go away */
@@ -62,7 +67,7 @@ static void build_enforce_convexity_left (Graph *g)
 
   if (!newclock)
     {
-      newclock = build_initial_node();
+      newclock = build_initial_node(arena);
       /* Link clockwise to newclock */
       clockwise->rotate_r->adjacent = newclock;
       newclock->adjacent = clockwise->rotate_r;
@@ -71,7 +76,7 @@ static void build_enforce_convexity_left (Graph *g)
 
   if (!newcc)
     {
-      newcc = build_initial_node();
+      newcc = build_initial_node(arena);
       /* Lock ccwise to newcc */
       ROTATE_L(ccwise)->adjacent = newcc;
       newcc->adjacent = ROTATE_L(ccwise);
@@ -82,10 +87,10 @@ static void build_enforce_convexity_left (Graph *g)
   ROTATE_L(newcc)->adjacent = newclock->rotate_r;
 
   /* recurse counterclockwise around the perimeter of the graph */
-  build_enforce_convexity_left(clockwise->rotate_r);
+  build_enforce_convexity_left(arena, clockwise->rotate_r);
 }
 
-static void build_enforce_convexity_right (Graph *g)
+static void build_enforce_convexity_right (Arena *arena, Graph *g)
 {
   if (!g)
     return; /* Go away */
@@ -106,7 +111,7 @@ static void build_enforce_convexity_right (Graph *g)
 
   if (!newclock)
     {
-      newclock = build_initial_node();
+      newclock = build_initial_node(arena);
       /* Link clockwise to newclock */
       clockwise->rotate_r->adjacent = newclock;
       newclock->adjacent = clockwise->rotate_r;
@@ -114,7 +119,7 @@ static void build_enforce_convexity_right (Graph *g)
 
   if (!newcc)
     {
-      newcc = build_initial_node();
+      newcc = build_initial_node(arena);
       /* Lock ccwise to newcc */
       ROTATE_L(ccwise)->adjacent = newcc;
       newcc->adjacent = ROTATE_L(ccwise);
@@ -125,26 +130,57 @@ static void build_enforce_convexity_right (Graph *g)
   ROTATE_L(newcc)->adjacent = newclock->rotate_r;
 
   /* recurse clockwise around the perimeter of the graph */
-  build_enforce_convexity_right(ROTATE_L(ccwise));
+  build_enforce_convexity_right(arena, ROTATE_L(ccwise));
 }
 
 
-void build_wall_in (Graph *graph)
+void build_wall_in (Arena *arena, Graph *graph)
 {
   for (size_t i = 0; i < 8; i++)
     {
       if (!graph->adjacent)
         {
-          graph->adjacent = build_initial_node();
+          graph->adjacent = build_initial_node(arena);
           graph->adjacent->adjacent = graph;
         }
-      build_enforce_convexity_left(graph);
-      build_enforce_convexity_right(graph);
+      build_enforce_convexity_left(arena, graph);
+      build_enforce_convexity_right(arena, graph);
       graph = graph->rotate_r;
     }
 }
 
-int build_add_node (Graph *graph, SavedTile *tile)
+/* Follow one character of a path from graph, building the tile ahead if a
+   step forward leaves the graph. */
+static Graph *build_follow (Arena *arena, Graph *graph, char direction)
+{
+  switch (direction)
+    {
+    case 'L': case 'l':
+      graph = graph->rotate_r;
+      /* Fall through */
+    case 'B': case 'b':
+      graph = graph->rotate_r;
+      /* Fall through. */
+    case 'R': case 'r':
+      graph = graph->rotate_r;
+      break;
+    case 'F': case 'f':
+
+      if (!graph->adjacent)
+        {
+          graph->adjacent = build_initial_node(arena);
+          graph->adjacent->adjacent = graph;
+          build_enforce_convexity_left(arena, graph);
+          build_enforce_convexity_right(arena, graph);
+        }
+
+      graph = ROTATE_B(graph->adjacent);
+      break;
+    }
+  return graph;
+}
+
+int build_add_node (Arena *arena, Graph *graph, SavedTile *tile)
 {
   if (!tile)
     return 0;
@@ -157,57 +193,77 @@ int build_add_node (Graph *graph, SavedTile *tile)
   
 
   for (; *direction_ptr; direction_ptr++)
-    {
-      switch (*direction_ptr)
-        {
-        case 'L': case 'l':
-          graph = graph->rotate_r;
-          /* Fall through */
-        case 'B': case 'b':
-          graph = graph->rotate_r;
-          /* Fall through. */
-        case 'R': case 'r':
-          graph = graph->rotate_r;
-          break;
-        case 'F': case 'f':
-
-          if (!graph->adjacent)
-            {
-              graph->adjacent = build_initial_node();
-              graph->adjacent->adjacent = graph;
-              build_enforce_convexity_left(graph);
-              build_enforce_convexity_right(graph);
-            }
-
-          graph = ROTATE_B(graph->adjacent);
-          break;
-        }
-    }
+    graph = build_follow(arena, graph, *direction_ptr);
 
   graph->tile->tile_type = tile->tile_type;
   graph->tile->agent = tile->agent;
 
   if (tile->tile_type != TILE_TYPE_WALL)
-    build_wall_in(graph);
+    build_wall_in(arena, graph);
 
   return 1;
 }
 
-Graph *build_graph (SavedTile *tiles)
+static int build_compare_paths (const void *a, const void *b)
 {
-  Graph *g = build_initial_node();
-  build_wall_in(g);
+  const SavedTile *x = *(SavedTile * const *) a;
+  const SavedTile *y = *(SavedTile * const *) b;
+  return strcmp(x->path, y->path);
+}
+
+/* Builds the same graph as calling build_add_node on each tile in turn, but
+   walks the paths in sorted order so that each only has to walk the part
+   it does not share with the one before, and walls everything in at the
+   end instead of after every tile. */
+Graph *build_graph (Arena *arena, SavedTile *tiles)
+{
+  Graph *g = build_initial_node(arena);
+  build_wall_in(arena, g);
   g->tile->tile_type = TILE_TYPE_SPACE;
-  int cont = 1;
-  for (size_t i = 0; cont; i++)
+
+  size_t num_tiles = 0, longest = 0;
+  for (; tiles[num_tiles].path; num_tiles++)
     {
-      if (build_add_node(g, &(tiles[i])))
-        continue;
-      else
-        break;
+      size_t length = strlen(tiles[num_tiles].path);
+      if (length > longest)
+        longest = length;
     }
 
-  return g;
-}
+  SavedTile **sorted = malloc(num_tiles * sizeof(SavedTile *));
+  for (size_t i = 0; i < num_tiles; i++)
+    sorted[i] = &(tiles[i]);
+  qsort(sorted, num_tiles, sizeof(SavedTile *), build_compare_paths);
+
+  /* trail[i] is where the first i characters of the last path lead */
+  Graph **trail = malloc((longest + 1) * sizeof(Graph *));
+  Graph **ends = malloc(num_tiles * sizeof(Graph *));
+  const char *last = "";
+  trail[0] = g;
+  for (size_t i = 0; i < num_tiles; i++)
+    {
+      const char *path = sorted[i]->path;
+      size_t shared = 0;
+      while (path[shared] && path[shared] == last[shared])
+        shared++;
+      for (; path[shared]; shared++)
+        trail[shared + 1] = build_follow(arena, trail[shared], path[shared]);
+      ends[sorted[i] - tiles] = trail[shared];
+      last = path;
+    }
 
+  /* In file order, so that a tile listed twice ends up as its last listing
+     says */
+  for (size_t i = 0; i < num_tiles; i++)
+    {
+      ends[i]->tile->tile_type = tiles[i].tile_type;
+      ends[i]->tile->agent = tiles[i].agent;
+    }
+  for (size_t i = 0; i < num_tiles; i++)
+    if (tiles[i].tile_type != TILE_TYPE_WALL)
+      build_wall_in(arena, ends[i]);
 
+  free(sorted);
+  free(trail);
+  free(ends);
+  return g;
+}
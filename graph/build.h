@@ -24,13 +24,16 @@
 #include <stddef.h>
 
 #include "graph.h"
+#include "arena.h"
 
-Graph *build_initial_node (void);
+/* Everything is allocated from arena, and lives as long as it does. */
 
-int build_add_node (Graph *graph, SavedTile *tile);
+Graph *build_initial_node (Arena *arena);
 
-Graph *build_graph (SavedTile *tiles);
+int build_add_node (Arena *arena, Graph *graph, SavedTile *tile);
 
-void build_wall_in (Graph *graph);
+Graph *build_graph (Arena *arena, SavedTile *tiles);
+
+void build_wall_in (Arena *arena, Graph *graph);
 
 #endif /* __HYPERBAN__BUILD_H */
@@ -0,0 +1,112 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "flat.h"
+#include "graph.h"
+
+#include <stdlib.h>
+
+FlatGraph *flat_compile (Graph *root)
+{
+  FlatGraph *flat = calloc(1, sizeof(FlatGraph));
+
+  /* Number the tiles.  nodes doubles as the queue. */
+  size_t size = 16;
+  flat->nodes = malloc(size * sizeof(Graph *));
+  flat->nodes[0] = root;
+  flat->num_tiles = 1;
+
+  VisitSet visits;
+  visit_init(&visits);
+  visit_begin(&visits);
+  visit_mark(&visits, root->tile);
+  uint32_t max_index = root->tile->index;
+  for (size_t i = 0; i < flat->num_tiles; i++)
+    {
+      Graph *g = flat->nodes[i];
+      for (int d = 0; d < 4; d++, g = g->rotate_r)
+        {
+          Graph *n = g->adjacent;
+          if (!n || visit_seen(&visits, n->tile))
+            continue;
+          visit_mark(&visits, n->tile);
+          if (n->tile->index > max_index)
+            max_index = n->tile->index;
+          if (flat->num_tiles == size)
+            {
+              size *= 2;
+              flat->nodes = realloc(flat->nodes, size * sizeof(Graph *));
+            }
+          flat->nodes[flat->num_tiles++] = n;
+        }
+    }
+  visit_destroy(&visits);
+
+  size_t n = flat->num_tiles;
+  flat->nodes = realloc(flat->nodes, n * sizeof(Graph *));
+
+  /* Tile.index -> flat index */
+  uint32_t *remap = malloc((max_index + 1) * sizeof(uint32_t));
+  for (size_t i = 0; i < n; i++)
+    remap[flat->nodes[i]->tile->index] = i;
+
+  flat->neighbor = malloc(4 * n * sizeof(uint32_t));
+  flat->tile_type = malloc(n);
+  flat->agent = malloc(n);
+  for (size_t i = 0; i < n; i++)
+    {
+      Graph *g = flat->nodes[i];
+      flat->tile_type[i] = g->tile->tile_type;
+      flat->agent[i] = g->tile->agent;
+      for (int d = 0; d < 4; d++, g = g->rotate_r)
+        {
+          if (!g->adjacent)
+            {
+              flat->neighbor[4 * i + d] = FLAT_NONE;
+              continue;
+            }
+          uint32_t j = remap[g->adjacent->tile->index];
+          uint32_t r = 0;
+          for (Graph *c = flat->nodes[j]; c != g->adjacent; c = c->rotate_r)
+            r++;
+          flat->neighbor[4 * i + d] = FLAT_ENTRY(j, r);
+        }
+    }
+
+  free(remap);
+  return flat;
+}
+
+void free_flat (FlatGraph *flat)
+{
+  free(flat->neighbor);
+  free(flat->tile_type);
+  free(flat->agent);
+  free(flat->nodes);
+  free(flat);
+}
+
+Graph *flat_node (const FlatGraph *flat, uint32_t entry)
+{
+  Graph *g = flat->nodes[FLAT_TILE(entry)];
+  for (uint32_t r = 0; r < FLAT_ORIENTATION(entry); r++)
+    g = g->rotate_r;
+  return g;
+}
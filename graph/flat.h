@@ -0,0 +1,60 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__FLAT_H
+#define __HYPERBAN__FLAT_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* Tiles are numbered in breadth-first order from the node the graph was
+   compiled from, which becomes tile 0 facing 0.  A node of the pointer graph
+   is an "entry": its tile index shifted left two, or'd with how many times
+   rotate_r takes the tile's canonical node to it.
+
+   neighbor[4 * t + d] is the entry for the node
+   rotate_r^d(nodes[t])->adjacent, or FLAT_NONE at the edge of the graph. */
+
+#define FLAT_NONE UINT32_MAX
+
+#define FLAT_ENTRY(t, r) (((uint32_t) (t) << 2) | ((r) & 3))
+#define FLAT_TILE(e) ((e) >> 2)
+#define FLAT_ORIENTATION(e) ((e) & 3)
+
+FlatGraph *flat_compile (Graph *root);
+void free_flat (FlatGraph *flat);
+
+/* The node of the pointer graph that entry stands for. */
+Graph *flat_node (const FlatGraph *flat, uint32_t entry);
+
+/* Step from entry in direction move and turn so that move still points the
+   way we were going, as perform_move does.  Returns FLAT_NONE at the edge of
+   the graph. */
+static inline uint32_t flat_step (const FlatGraph *flat, uint32_t entry,
+                                  Move move)
+{
+  uint32_t n = flat->neighbor[(entry & ~3u) | ((entry + move) & 3)];
+  if (n == FLAT_NONE)
+    return FLAT_NONE;
+  return (n & ~3u) | ((n + 6 - move) & 3);
+}
+
+#endif /* __HYPERBAN__FLAT_H */
@@ -24,100 +24,297 @@
 #include <string.h>
 #include <time.h>
 
+#include "arena.h"
+#include "audit.h"
+#include "board.h"
 #include "build.h"
+#include "flat.h"
+#include "graph.h"
+#include "sokoban.h"
+#include "zobrist.h"
 
 static const GeneratorParams default_params = {
   GENERATOR_DEFAULT_MIN_SIZE,
   GENERATOR_DEFAULT_SIZE_RANGE,
   GENERATOR_DEFAULT_MAX_DEAD_ENDS,
-  GENERATOR_DEFAULT_NUM_GOALS
+  GENERATOR_DEFAULT_NUM_GOALS,
+  GENERATOR_DEFAULT_NUM_PULLS
 };
 
-static Graph *generate_room(const GeneratorParams *params) {
-  Graph *start = build_initial_node();
+/* splitmix64, on the finalizer the Zobrist keys use.  Each board is made
+   from a state of its own, so that a seed always gives the same level, and
+   threads needn't share one. */
+static uint32_t next_random(uint64_t *rng) {
+  return zobrist_mix(*rng += 0x9e3779b97f4a7c15ULL) >> 32;
+}
 
-  size_t num_walls = 1;
-  Graph **walls = malloc(sizeof(Graph *));
-  walls[0] = start;
-  start->tile->search_flag = 1;
+/* Scratch space for generate_room, kept between attempts. */
+typedef struct {
+  Graph **walls; /* the frontier: walls next to the room */
+  Graph **floors;
+  size_t num_floors;
+  VisitSet frontier;
+  VisitSet walled; /* tiles already walled in by an earlier attempt */
+} Carving;
 
-  Graph **floors = NULL;
-  size_t num_floors = 0;
+/* Carve a room out of solid wall from start a tile at a time, each a
+   random pick from the frontier, until it is the size wanted.  Returns
+   how many dead ends it has.  The frontier grows by at most three tiles
+   for each tile carved, so c->walls never needs more room than it was
+   given. */
+static size_t carve_room(Arena *arena, const GeneratorParams *params,
+    uint64_t *rng, Graph *start, Carving *c) {
+  visit_begin(&c->frontier);
+  size_t num_walls = 1;
+  c->walls[0] = start;
+  visit_mark(&c->frontier, start->tile);
+  c->num_floors = 0;
 
-  size_t room_size;
-  size_t goal_size = params->min_size + (rand() % params->size_range);
+  size_t goal_size = params->min_size + (next_random(rng) % params->size_range);
   goal_size += params->num_goals;
   size_t num_targets = 0;
 
-  for (room_size = 0; room_size < goal_size; room_size++) {
-    size_t index = rand() % num_walls;
+  for (size_t room_size = 0; room_size < goal_size; room_size++) {
+    /* Swap the last wall into the gap; the order is random anyway */
+    size_t index = next_random(rng) % num_walls;
+    Graph *t = c->walls[index];
+    c->walls[index] = c->walls[--num_walls];
 
-    Graph *t = walls[index];
-
-    if (rand() % (goal_size - room_size) < params->num_goals-num_targets) {
+    if (next_random(rng) % (goal_size - room_size) <
+        params->num_goals - num_targets) {
       t->tile->tile_type = TILE_TYPE_TARGET;
       num_targets++;
     } else {
       t->tile->tile_type = TILE_TYPE_SPACE;
     }
+    c->floors[c->num_floors++] = t;
 
-    floors = realloc(floors, ++num_floors * sizeof(Graph *));
-    floors[num_floors-1] = t;
-
-    build_wall_in(t);
-
-    t->tile->search_flag = 0;
-
-    memmove(&walls[index],
-        &walls[index+1], sizeof(Graph *)*(--num_walls - index));
-
-    walls = realloc(walls, num_walls * sizeof(Graph *));
+    if (!visit_seen(&c->walled, t->tile)) {
+      build_wall_in(arena, t);
+      visit_mark(&c->walled, t->tile);
+    }
 
     Graph *t2 = t;
     for (size_t i = 0; i < 4; i++) {
       t2 = t2->rotate_r;
-      if (t2->adjacent->tile->search_flag == 0 &&
+      if (!visit_seen(&c->frontier, t2->adjacent->tile) &&
           t2->adjacent->tile->tile_type == TILE_TYPE_WALL) {
-        walls = realloc(walls, (++num_walls) * sizeof(Graph *));
-        walls[num_walls-1] = t2->adjacent;
-        walls[num_walls-1]->tile->search_flag = 1;
+        c->walls[num_walls++] = t2->adjacent;
+        visit_mark(&c->frontier, t2->adjacent->tile);
       }
     }
   }
-  for (size_t i = 0; i < num_walls; i++) {
-    walls[i]->tile->search_flag = 0;
-  }
-  free(walls);
 
   size_t dead_ends = 0;
-  for (size_t i = 0; i < num_floors; i++) {
+  for (size_t i = 0; i < c->num_floors; i++) {
     size_t neighbors = 0;
-    Graph *t = floors[i];
+    Graph *t = c->floors[i];
     for (size_t j = 0; j < 4; j++) {
       t = t->rotate_r;
       if (t->adjacent->tile->tile_type != TILE_TYPE_WALL) neighbors++;
     }
     if (neighbors == 1) dead_ends++;
   }
+  return dead_ends;
+}
+
+/* Carve rooms until one has few enough dead ends, or return NULL after
+   GENERATOR_CARVE_ATTEMPTS.  A room that fails is filled back in, but the
+   tiles built around it stay, so later attempts only build what is new to
+   them; the arena is only cleared once it holds
+   GENERATOR_MAX_REUSED_TILES.  The room that succeeds is carved again,
+   from the same random numbers, in a cleared arena, so that the board
+   holds no walls but its own. */
+static Graph *generate_room(Arena *arena, const GeneratorParams *params,
+    uint64_t *rng) {
+  size_t most = params->min_size + params->size_range + params->num_goals;
+  Carving c;
+  c.walls = malloc((3 * most + 1) * sizeof(Graph *));
+  c.floors = malloc(most * sizeof(Graph *));
+  visit_init(&c.frontier);
+  visit_init(&c.walled);
+  visit_begin(&c.walled);
+
+  Graph *start = build_initial_node(arena);
+  int reused = 0;
+  for (size_t attempt = 0;; attempt++) {
+    if (attempt == GENERATOR_CARVE_ATTEMPTS) {
+      start = NULL;
+      break;
+    }
+    uint64_t saved = *rng;
+    if (carve_room(arena, params, rng, start, &c) <= params->max_dead_ends) {
+      if (reused) {
+        arena_reset(arena);
+        visit_begin(&c.walled);
+        *rng = saved;
+        start = build_initial_node(arena);
+        carve_room(arena, params, rng, start, &c);
+      }
+      break;
+    }
+
+    for (size_t i = 0; i < c.num_floors; i++)
+      c.floors[i]->tile->tile_type = TILE_TYPE_WALL;
+    reused = 1;
+    if (arena->num_tiles > GENERATOR_MAX_REUSED_TILES) {
+      arena_reset(arena);
+      visit_begin(&c.walled);
+      start = build_initial_node(arena);
+      reused = 0;
+    }
+  }
+
+  visit_destroy(&c.frontier);
+  visit_destroy(&c.walled);
+  free(c.walls);
+  free(c.floors);
+  return start;
+}
+
+static int open_tile(const FlatGraph *f, const char *agent, uint32_t entry) {
+  return entry != FLAT_NONE &&
+    f->tile_type[FLAT_TILE(entry)] != TILE_TYPE_WALL &&
+    agent[FLAT_TILE(entry)] != AGENT_BOX;
+}
+
+/* Walk to somewhere a box can be pulled from, chosen at random among all
+   of them, and pull it with unperform_flat_move.  Returns the tile the box
+   was on, or FLAT_NONE if there was nothing to pull.  seen and queue are
+   scratch space, a tile each. */
+static uint32_t random_pull(const FlatGraph *f, char *agent, uint32_t *player,
+    char *seen, uint32_t *queue, uint64_t *rng) {
+  size_t head = 0, tail = 0, num_pulls = 0;
+  uint32_t pull = FLAT_NONE;
+  memset(seen, 0, f->num_tiles);
+  seen[FLAT_TILE(*player)] = 1;
+  queue[tail++] = FLAT_TILE(*player);
+  while (head < tail) {
+    uint32_t t = queue[head++];
+    for (int d = 0; d < 4; d++) {
+      uint32_t n = f->neighbor[4 * t + d];
+      if (n != FLAT_NONE && agent[FLAT_TILE(n)] == AGENT_BOX &&
+          open_tile(f, agent, f->neighbor[4 * t + ((d + 2) & 3)]) &&
+          next_random(rng) % ++num_pulls == 0)
+        pull = FLAT_ENTRY(t, d);
+      if (!open_tile(f, agent, n) || seen[FLAT_TILE(n)])
+        continue;
+      seen[FLAT_TILE(n)] = 1;
+      queue[tail++] = FLAT_TILE(n);
+    }
+  }
+  if (pull == FLAT_NONE)
+    return FLAT_NONE;
+
+  /* Facing the box, so that undoing a push up pulls it */
+  int unsolved = 0;
+  uint64_t hash = 0;
+  *player = pull;
+  unperform_flat_move(f, agent, player, &unsolved, &hash,
+      sokoban_get_move_abbreviation(MOVE_UP, 1));
+  return FLAT_TILE(f->neighbor[pull]);
+}
+
+/* Place the boxes by playing backwards from the solution: a box on every
+   target, then random pulls.  Pushing the same way back again solves
+   whatever position this reaches, so the level can always be solved.  The
+   position kept is the deepest one met, with the boxes furthest in all
+   from the targets; when the player gets boxed in, the pulls start over
+   from the solution.  Returns how many pushes the boxes are from the
+   targets, not counting each other. */
+static uint32_t scatter_boxes(Board *board, const GeneratorParams *params,
+    uint64_t *rng) {
+  FlatGraph *f = board->flat;
+  size_t n = f->num_tiles;
+  char *agent = malloc(n);
+  char *best = malloc(n);
+
+  /* The player starts on any floor that isn't a target */
+  uint32_t player = FLAT_NONE;
+  size_t num_free = 0;
+  for (uint32_t t = 0; t < n; t++) {
+    agent[t] = f->tile_type[t] == TILE_TYPE_TARGET ? AGENT_BOX : AGENT_NONE;
+    if (f->tile_type[t] == TILE_TYPE_SPACE &&
+        next_random(rng) % ++num_free == 0)
+      player = FLAT_ENTRY(t, next_random(rng) % 4);
+  }
+  if (player == FLAT_NONE) {
+    free(agent);
+    free(best);
+    return 0;
+  }
+
+  uint32_t *dist = audit_pull_distances(f);
+  char *seen = malloc(n);
+  uint32_t *queue = malloc(n * sizeof(uint32_t));
+  char *start = malloc(n);
+  memcpy(start, agent, n);
+  memcpy(best, agent, n);
+  uint32_t start_player = player, best_player = player;
+  uint32_t depth = 0, best_depth = 0;
+  for (size_t i = 0; i < params->num_pulls; i++) {
+    uint32_t from = random_pull(f, agent, &player, seen, queue, rng);
+    if (from == FLAT_NONE) {
+      /* Boxed in: start again */
+      memcpy(agent, start, n);
+      player = start_player;
+      depth = 0;
+      continue;
+    }
+    /* The box is now where the player was */
+    depth += dist[FLAT_TILE(f->neighbor[player])] - dist[from];
+    if (depth > best_depth) {
+      memcpy(best, agent, n);
+      best_player = player;
+      best_depth = depth;
+    }
+  }
 
-  free(floors);
-  if (dead_ends > params->max_dead_ends) {
-    free_graph(start);
-    return generate_room(params);
-  } else {
-   return start;
+  /* Put the position into the pointer graph and compile it afresh, from
+     where the player ends up */
+  board->unsolved = 0;
+  for (uint32_t t = 0; t < n; t++) {
+    f->nodes[t]->tile->agent = best[t];
+    if (best[t] == AGENT_BOX && f->tile_type[t] != TILE_TYPE_TARGET)
+      board->unsolved++;
   }
+  board->graph = flat_node(f, best_player);
+  board_compile(board);
+
+  free(dist);
+  free(seen);
+  free(queue);
+  free(agent);
+  free(start);
+  free(best);
+  return best_depth;
 }
 
 Board *generate_board(const GeneratorParams *params) {
-  srand(time(NULL));
+  return generate_board_seeded(params, time(NULL));
+}
 
+Board *generate_board_seeded(const GeneratorParams *params, uint64_t seed) {
   if (params == NULL) {
     params = &default_params;
   }
 
+  uint64_t rng = seed;
   Board *board = calloc(1, sizeof(Board));
-  board->graph = generate_room(params);
+  board->arena = new_arena();
+  /* A room where no box can be moved makes no puzzle, so try another */
+  for (int i = 0; i < GENERATOR_ROOM_ATTEMPTS; i++) {
+    if (i > 0)
+      arena_reset(board->arena);
+    board->graph = generate_room(board->arena, params, &rng);
+    if (board->graph == NULL) {
+      free_board(board);
+      return NULL;
+    }
+    board_compile(board);
+    if (params->num_pulls == 0 || scatter_boxes(board, params, &rng) > 0)
+      break;
+  }
 
   return board;
 }
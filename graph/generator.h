@@ -21,6 +21,8 @@
 #ifndef __HYPERBAN_GENERATOR_H
 #define __HYPERBAN_GENERATOR_H
 
+#include <stdint.h>
+
 #include "types.h"
 
 struct generator_params_t {
@@ -28,15 +30,29 @@ struct generator_params_t {
   size_t size_range;
   size_t max_dead_ends;
   size_t num_goals;
+  size_t num_pulls; /* played backwards to place the boxes; 0 places none */
 };
 
 typedef struct generator_params_t GeneratorParams;
 
+/* A random level, seeded from the time, or NULL if no room with few
+   enough dead ends turned up in GENERATOR_CARVE_ATTEMPTS. */
 Board *generate_board(const GeneratorParams *params);
+/* The level seed makes: the same every time, and safe to call from many
+   threads at once.  NULL as above. */
+Board *generate_board_seeded(const GeneratorParams *params, uint64_t seed);
 
 #define GENERATOR_DEFAULT_MIN_SIZE 10
 #define GENERATOR_DEFAULT_SIZE_RANGE 5
 #define GENERATOR_DEFAULT_MAX_DEAD_ENDS 0
 #define GENERATOR_DEFAULT_NUM_GOALS 2
+#define GENERATOR_DEFAULT_NUM_PULLS 200
+
+/* Rooms tried for one where the boxes can be moved at all */
+#define GENERATOR_ROOM_ATTEMPTS 100
+/* Rooms carved for one with few enough dead ends before giving up */
+#define GENERATOR_CARVE_ATTEMPTS 10000000
+/* Tiles a failed room's arena may hold and still be carved again */
+#define GENERATOR_MAX_REUSED_TILES 65536
 
 #endif /* __HYPERBAN_GENERATOR_H */
@@ -23,54 +23,30 @@
 #include <stdlib.h>
 #include <string.h>
 
-void clear_search(Graph* graph) {
-  graph->tile->search_flag = 0;
-  if (graph->adjacent && graph->adjacent->tile->search_flag) {
-    clear_search(graph->adjacent);
-  }
-  if (graph->rotate_r->adjacent && graph->rotate_r->adjacent->tile->search_flag) {
-    clear_search(graph->rotate_r->adjacent);
-  }
-  if (ROTATE_B(graph)->adjacent && ROTATE_B(graph)->adjacent->tile->search_flag) {
-    clear_search(ROTATE_B(graph)->adjacent);
-  }
-  if (ROTATE_L(graph)->adjacent && ROTATE_L(graph)->adjacent->tile->search_flag) {
-    clear_search(ROTATE_L(graph)->adjacent);
-  }
+void visit_init(VisitSet *v) {
+  v->stamps = NULL;
+  v->size = 0;
+  v->epoch = 0;
 }
 
-void free_graph(Graph *graph) {
-  Graph** all_nodes = NULL;
-  size_t num_nodes = 0;
-  Graph** stack = malloc(sizeof(Graph*));
-  stack[0] = graph;
-  size_t num_stack = 1;
-  while (num_stack) {
-    Graph *g = stack[--num_stack];
-    if (g == NULL) continue;
-    /* if g->tile is NULL, we've already added g (and it's ring) to
-       all_nodes */
-    if (g->tile == NULL) continue;
-    Graph* ring[4] = { g, g->rotate_r, ROTATE_B(g), ROTATE_L(g)};
-    free(g->tile);
-    for (int i = 0; i < 4; i++) {
-      ring[i]->tile = NULL;
-    }
-    Graph *neighbors[4]= {
-      ring[0]->adjacent,
-      ring[1]->adjacent,
-      ring[2]->adjacent,
-      ring[3]->adjacent
-    };
-    stack = realloc(stack, (num_stack+4) * (sizeof(Graph*)));
-    memcpy(stack+num_stack, &neighbors, 4 * sizeof(Graph*));
-    num_stack += 4;
+void visit_destroy(VisitSet *v) {
+  free(v->stamps);
+  visit_init(v);
+}
 
-    all_nodes = realloc(all_nodes, (num_nodes+4) * sizeof(Graph*));
-    memcpy(all_nodes+num_nodes, &ring, 4 * sizeof(Graph*));
-    num_nodes += 4;
-  }
-  for (size_t i = 0; i < num_nodes; i++) {
-    free(all_nodes[i]);
+void visit_begin(VisitSet *v) {
+  if (++v->epoch == 0) {
+    /* Wrapped around: old stamps could now look current. */
+    memset(v->stamps, 0, v->size * sizeof(uint32_t));
+    v->epoch = 1;
   }
 }
+
+void visit_grow(VisitSet *v, uint32_t index) {
+  size_t size = v->size ? v->size : 64;
+  while (size <= index)
+    size *= 2;
+  v->stamps = realloc(v->stamps, size * sizeof(uint32_t));
+  memset(v->stamps + v->size, 0, (size - v->size) * sizeof(uint32_t));
+  v->size = size;
+}
@@ -21,13 +21,39 @@
 #ifndef __HYPERBAN__GRAPH_H
 #define __HYPERBAN__GRAPH_H
 
+#include <stdint.h>
+
 #include "types.h"
 
 #define ROTATE_L(g) ((g)->rotate_r->rotate_r->rotate_r)
 #define ROTATE_B(g) ((g)->rotate_r->rotate_r)
 
-void clear_search(Graph* graph);
+/* Which tiles a traversal has seen, kept beside the graph rather than in
+   it.  A tile counts as visited when its stamp equals the current epoch, so
+   visit_begin forgets everything in O(1).  Concurrent traversals just need
+   a VisitSet each. */
+typedef struct {
+  uint32_t *stamps; /* indexed by Tile.index */
+  size_t size;
+  uint32_t epoch;
+} VisitSet;
+
+void visit_init(VisitSet *v);
+void visit_destroy(VisitSet *v);
+
+/* Start a new traversal: every tile becomes unvisited. */
+void visit_begin(VisitSet *v);
+
+void visit_grow(VisitSet *v, uint32_t index);
+
+static inline int visit_seen(const VisitSet *v, const Tile *t) {
+  return t->index < v->size && v->stamps[t->index] == v->epoch;
+}
 
-void free_graph(Graph *graph);
+static inline void visit_mark(VisitSet *v, const Tile *t) {
+  if (t->index >= v->size)
+    visit_grow(v, t->index);
+  v->stamps[t->index] = v->epoch;
+}
 
 #endif /* __HYPERBAN__GRAPH_H */
@@ -0,0 +1,197 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "hbl.h"
+#include "arena.h"
+#include "audit.h"
+#include "board.h"
+#include "build.h"
+#include "flat.h"
+#include "zobrist.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int hbl_is_binary (const char *filename)
+{
+  size_t n = strlen(filename), e = strlen(HBL_EXTENSION);
+  return n >= e && !strcmp(filename + n - e, HBL_EXTENSION);
+}
+
+/* Whether the corner of tile t between edges d and d + 1 has five tiles
+   around it, as every corner of the {4,5} tiling does.  Going around it
+   crosses one edge of each, and the corner is the one before the edge
+   crossed in from; after five the walk is back at t, in across d + 1.  A
+   corner on the edge of the level can't be walked around and passes. */
+static int hbl_corner (const uint32_t *neighbor, uint32_t t, uint32_t d)
+{
+  uint32_t e = FLAT_ENTRY(t, d);
+  for (int i = 0; i < 5; i++)
+    {
+      e = neighbor[e];
+      if (e == FLAT_NONE)
+        return 1;
+      e = FLAT_ENTRY(FLAT_TILE(e), (FLAT_ORIENTATION(e) + 3) & 3);
+    }
+  return e == FLAT_ENTRY(t, d);
+}
+
+/* Whether the size bytes at data hold a sound level: everything the
+   header promises is there, each link between tiles goes both ways to
+   another tile, every corner is one the tiling has, every code is one a
+   tile can have, and the player's tile is floor without a box. */
+static int hbl_check (const char *data, size_t size)
+{
+  const HblHeader *h = (const HblHeader *) data;
+  if (size < sizeof(HblHeader)
+      || memcmp(h->magic, HBL_MAGIC, sizeof(h->magic))
+      || h->byte_order != HBL_BYTE_ORDER
+      || h->num_tiles == 0 || h->num_tiles > FLAT_TILE(FLAT_NONE))
+    return 0;
+
+  size_t n = h->num_tiles;
+  if (size != sizeof(HblHeader) + 4 * n * sizeof(uint32_t)
+      + 2 * HBL_CODES_SIZE(n) + h->title_length + h->collection_length)
+    return 0;
+
+  /* An entry is the index of its own slot in the table. */
+  const uint32_t *neighbor = (const uint32_t *) (h + 1);
+  for (size_t e = 0; e < 4 * n; e++)
+    if (neighbor[e] != FLAT_NONE
+        && (FLAT_TILE(neighbor[e]) >= n || neighbor[neighbor[e]] != e
+            || FLAT_TILE(neighbor[e]) == FLAT_TILE(e)))
+      return 0;
+  for (uint32_t e = 0; e < 4 * n; e++)
+    if (!hbl_corner(neighbor, FLAT_TILE(e), FLAT_ORIENTATION(e)))
+      return 0;
+
+  const uint8_t *tile_types = (const uint8_t *) (neighbor + 4 * n);
+  const uint8_t *agents = tile_types + HBL_CODES_SIZE(n);
+  for (size_t t = 0; t < n; t++)
+    if (HBL_CODE(tile_types, t) > TILE_TYPE_TARGET
+        || HBL_CODE(agents, t) > AGENT_BOX)
+      return 0;
+  return HBL_CODE(tile_types, 0) != TILE_TYPE_WALL
+    && HBL_CODE(agents, 0) == AGENT_NONE;
+}
+
+static char *hbl_string (const char *s, uint32_t length)
+{
+  if (!length)
+    return NULL;
+  char *r = malloc(length + 1);
+  memcpy(r, s, length);
+  r[length] = '\0';
+  return r;
+}
+
+/* Build a board from a checked level.  The flat graph is copied from the
+   file as it is; the pointer graph is built from the same table, so that
+   tile t's canonical node is the one flat_node finds. */
+static Board *hbl_assemble (const HblHeader *h)
+{
+  size_t n = h->num_tiles;
+  const uint32_t *neighbor = (const uint32_t *) (h + 1);
+  const uint8_t *tile_types = (const uint8_t *) (neighbor + 4 * n);
+  const uint8_t *agents = tile_types + HBL_CODES_SIZE(n);
+  const char *title = (const char *) (agents + HBL_CODES_SIZE(n));
+
+  Board *board = calloc(1, sizeof(Board));
+  board->arena = new_arena();
+
+  FlatGraph *f = calloc(1, sizeof(FlatGraph));
+  f->num_tiles = n;
+  f->neighbor = malloc(4 * n * sizeof(uint32_t));
+  memcpy(f->neighbor, neighbor, 4 * n * sizeof(uint32_t));
+  f->tile_type = malloc(n);
+  f->agent = malloc(n);
+  f->nodes = malloc(n * sizeof(Graph *));
+  for (size_t t = 0; t < n; t++)
+    {
+      Graph *g = build_initial_node(board->arena);
+      g->tile->tile_type = f->tile_type[t] = HBL_CODE(tile_types, t);
+      g->tile->agent = f->agent[t] = HBL_CODE(agents, t);
+      if (g->tile->agent == AGENT_BOX
+          && g->tile->tile_type != TILE_TYPE_TARGET)
+        board->unsolved++;
+      f->nodes[t] = g;
+    }
+  for (uint32_t e = 0; e < 4 * n; e++)
+    if (neighbor[e] != FLAT_NONE)
+      flat_node(f, e)->adjacent = flat_node(f, neighbor[e]);
+
+  board->graph = f->nodes[0];
+  board->flat = f;
+  board->player = FLAT_ENTRY(0, 0);
+  board->hash = zobrist_board(board);
+
+  board->moves_length = 4;
+  board->moves = calloc(board->moves_length, sizeof(char));
+  board->difficulty = h->difficulty;
+  board->level_number = h->level_number;
+  board->level_title = hbl_string(title, h->title_length);
+  board->collection_title = hbl_string(title + h->title_length,
+                                       h->collection_length);
+
+  if (!audit_board(board))
+    {
+      free_board(board);
+      return NULL;
+    }
+  return board;
+}
+
+Board *hbl_load (const char *filename)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    {
+      perror(filename);
+      return NULL;
+    }
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+    {
+      perror(filename);
+      close(fd);
+      return NULL;
+    }
+
+  size_t size = st.st_size;
+  void *data = MAP_FAILED;
+  if (size)
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  Board *board = NULL;
+  if (data != MAP_FAILED && hbl_check(data, size))
+    board = hbl_assemble(data);
+  else
+    fprintf(stderr, "%s is not a binary level.\n", filename);
+
+  if (data != MAP_FAILED)
+    munmap(data, size);
+  return board;
+}
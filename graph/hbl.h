@@ -0,0 +1,67 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__HBL_H
+#define __HYPERBAN__HBL_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* A binary level, in a file ending in HBL_EXTENSION, is a compiled board
+   as flat.h has it, so loading one needs no parsing: the file is mapped
+   into memory and the board built straight from it.  In order:
+
+     HblHeader
+     uint32_t neighbor[4 * num_tiles]  as FlatGraph.neighbor
+     uint8_t tile_types[(num_tiles + 3) / 4]  two bits a tile, the lowest
+     uint8_t agents[(num_tiles + 3) / 4]      bits for the lowest tile
+     char title[title_length]  not terminated
+     char collection[collection_length]
+
+   Tile 0 facing 0 is the player.  Numbers are in the byte order of the
+   machine that wrote the file; byte_order tells a machine with the other
+   order not to read it. */
+
+#define HBL_EXTENSION ".hbl"
+#define HBL_MAGIC "HBL\1"
+#define HBL_BYTE_ORDER 0x01020304
+
+typedef struct {
+  char magic[4]; /* HBL_MAGIC */
+  uint32_t byte_order; /* HBL_BYTE_ORDER */
+  uint32_t num_tiles;
+  int32_t difficulty;
+  int32_t level_number;
+  uint32_t title_length; /* 0 without a title */
+  uint32_t collection_length;
+} HblHeader;
+
+#define HBL_CODES_SIZE(num_tiles) (((size_t) (num_tiles) + 3) / 4)
+#define HBL_CODE(codes, t) (((codes)[(t) / 4] >> (2 * ((t) % 4))) & 3)
+
+/* Whether filename ends in HBL_EXTENSION. */
+int hbl_is_binary (const char *filename);
+
+/* Load a binary level.  Returns NULL, having said why on stderr, if the
+   file can't be read or doesn't hold a sound board. */
+Board *hbl_load (const char *filename);
+
+#endif /* __HYPERBAN__HBL_H */
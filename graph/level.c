@@ -100,20 +100,33 @@ int level_parse_file (FILE *f,
         }
       else
         {
-          r[r_used].path = NULL; /* required to use the %ms sscanf
-                                       extension */
+          char *rest = NULL; /* required to use the %ms sscanf
+                                extension */
+          int start = 0;
           if (sscanf(line_ptr,
-                     " %hhd "LF_DELIM" %hhd "LF_DELIM" %m[a-zA-Z]",
+                     " %hhd "LF_DELIM" %hhd "LF_DELIM" %n",
                      &(r[r_used].tile_type),
                      &(r[r_used].agent),
-                     &(r[r_used].path)) < 2)
+                     &start) < 2)
             goto LEVEL_FAIL;
 
-          if (!(r[r_used].path))
-            {
-              /* NULL path: replace it with empty null-terminated string */
-              r[r_used].path = calloc(1, sizeof(char));
-            }
+          /* The path may start with how many characters it shares with
+             the path on the tile line before. */
+          char *parsee = start ? line_ptr + start : "";
+          size_t shared = strtoul(parsee, &parsee, 10);
+          size_t previous = r_used ? strlen(r[r_used - 1].path) : 0;
+          if (shared > previous)
+            goto LEVEL_FAIL;
+          sscanf(parsee, "%m[a-zA-Z]", &rest);
+
+          size_t length = rest ? strlen(rest) : 0;
+          r[r_used].path = malloc(shared + length + 1);
+          if (shared)
+            memcpy(r[r_used].path, r[r_used - 1].path, shared);
+          if (rest)
+            memcpy(r[r_used].path + shared, rest, length);
+          r[r_used].path[shared + length] = '\0';
+          free(rest);
 
           r_used++;
           if (r_used >= r_size)
@@ -29,6 +29,11 @@
 
 #define LF_DELIM "|"
 
+/* A tile line is its type, its agent and its path from the start, as
+   "%d|%d|%s".  The path may begin with a number, which stands for that
+   many characters from the start of the path on the tile line before, so
+   0|0|RFLF followed by 0|0|2RF means the second tile is at RFRF. */
+
 /* Parse a level from the file f. */
 int level_parse_file (FILE *f, SavedTile **tiles, ConfigOption **options);
 
@@ -20,8 +20,6 @@
 
 
 
-
-
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -29,121 +27,158 @@
 #include "types.h"
 #include "level.h"
 #include "graph.h"
+#include "flat.h"
+#include "hbl.h"
 
-typedef struct queue_item_t {
-  Graph *g;
-  unsigned short refs;
-  char whence;
-  struct queue_item_t *parent;
-} QueueItem;
-
-typedef struct node_t {
-  struct node_t *next;
-  QueueItem *item;
-} Node;
+/* The tiles are written out breadth-first from the player, each with the
+   path that first reached it.  Every tile is queued at most once, so the
+   queue is an array as long as the arena has tiles, and an entry's parent
+   is its index in that array.  A path is written as how many characters
+   it shares with the path on the line before, then the rest of it; see
+   level.h. */
 
 typedef struct {
-  Node *first; /* First is first in line. */
-  Node *last;
+  Graph **g;
+  uint32_t *parent;
+  uint32_t *depth; /* steps from the player */
+  uint32_t *length; /* characters in the path */
+  char *whence; /* the turn before the step here, or '\0' */
 } Queue;
 
-
-Queue *new_queue () {
-  return calloc(1, sizeof(Queue));
-}
-
-void enqueue (Queue *q, QueueItem *item) {
-  Node *tmp = malloc(sizeof(Node));
-  tmp->next = NULL;
-  tmp->item = item;
-  if (q->last) {
-    q->last->next = tmp;
-  } else {
-    q->first = tmp;
+/* Write the path to entry i, given that last was written on the line
+   before, as what it shares with last and then the rest. */
+static void print_path (const Queue *q, uint32_t i, uint32_t last,
+                        char *rest, FILE *file) {
+  /* Climb to where the two paths meet.  Sibling steps start with
+     different characters, so the paths share exactly the meeting
+     entry's path. */
+  uint32_t a = i, b = last;
+  char *end = rest + q->length[i], *r = end;
+  while (a != b) {
+    if (q->depth[a] >= q->depth[b]) {
+      *--r = 'F';
+      if (q->whence[a] != '\0') {
+        *--r = q->whence[a];
+      }
+      a = q->parent[a];
+    } else {
+      b = q->parent[b];
+    }
   }
-  q->last = tmp;
-}
-
-QueueItem *dequeue (Queue *q) {
-  Node *tmp = q->first;
-  if (!tmp)  return NULL; /* Empty queue */
-  if (tmp->next) {
-    q->first = tmp->next;
-  } else {
-    q->first = NULL; /* Queue is now empty */
-    q->last = NULL;
+  if (q->length[a]) {
+    fprintf(file, "%u", q->length[a]);
   }
-  QueueItem *returnee = tmp->item;
-  free(tmp);
-  return returnee;
+  fwrite(r, 1, end - r, file);
 }
 
-void print_path (QueueItem *qi, FILE *file) {
-  if (qi->parent) {
-    print_path(qi->parent, file);
-    if (qi->whence != '\0') {
-      fputc(qi->whence, file);
-    }
-    fputc('F', file);
-  }
-};
-
-void serialize_node (QueueItem *qi, FILE *file, Queue *q) {
+static void serialize_graph (Graph *g, size_t num_tiles, FILE *file) {
   const char chars[] = "BL\0R";
-  Graph *g = qi->g;
+  Queue q;
+  q.g = malloc(num_tiles * sizeof(Graph *));
+  q.parent = malloc(num_tiles * sizeof(uint32_t));
+  q.depth = malloc(num_tiles * sizeof(uint32_t));
+  q.length = malloc(num_tiles * sizeof(uint32_t));
+  q.whence = malloc(num_tiles);
+  char *seen = calloc(num_tiles, 1);
+  char *rest = malloc(2 * num_tiles); /* no path is longer */
+
+  uint32_t head = 0, tail = 0, last = 0;
+  q.g[tail] = g;
+  q.parent[tail] = 0;
+  q.depth[tail] = 0;
+  q.length[tail] = 0;
+  q.whence[tail] = '\0';
+  seen[g->tile->index] = 1;
+  tail++;
+
+  while (head < tail) {
+    uint32_t i = head++;
+    g = q.g[i];
+
+    /* Enqueue neighbours */
+    for (int d = 0; d < 4; d++, g = g->rotate_r) {
+      if (!g->adjacent || seen[g->adjacent->tile->index]) {
+        continue;
+      }
+      seen[g->adjacent->tile->index] = 1;
+      q.g[tail] = g->adjacent;
+      q.parent[tail] = i;
+      q.depth[tail] = q.depth[i] + 1;
+      q.length[tail] = q.length[i] + (chars[d] ? 2 : 1);
+      q.whence[tail] = chars[d];
+      tail++;
+    }
 
-  /* Enqueue neighbours */
-  for (int i = 0; i < 4; i++, g = g->rotate_r) {
-    if (!g->adjacent || g->adjacent->tile->search_flag) {
-      continue;
+    /* Write out node */
+    if (g->tile->tile_type != TILE_TYPE_WALL) {
+      fprintf(file, "%i"LF_DELIM"%i"LF_DELIM, g->tile->tile_type,
+              g->tile->agent);
+      print_path(&q, i, last, rest, file);
+      fputc('\n', file);
+      last = i;
     }
-    QueueItem *new = malloc(sizeof(QueueItem));
-    new->g = g->adjacent;
-    new->refs = 0;
-    new->whence = chars[i];
-    new->parent = qi;
-    enqueue(q, new);
-    qi->refs++;
   }
 
-  /* Write out node */
-  if (g->tile->tile_type != TILE_TYPE_WALL) {
-    fprintf(file, "%i"LF_DELIM"%i"LF_DELIM, g->tile->tile_type, g->tile->agent);
-    print_path(qi, file);
-    fputc('\n', file);
-  }
+  free(q.g);
+  free(q.parent);
+  free(q.depth);
+  free(q.length);
+  free(q.whence);
+  free(seen);
+  free(rest);
+}
 
-  /* Garbage collect, recursively */
-  QueueItem *gcee = qi;
-  while (gcee->refs == 0) {
-    QueueItem *tmp = gcee->parent;
-    tmp->refs--;
-    free(gcee);
-    gcee = tmp;
+void serialize_board (Board *board, FILE *file) {
+  if (board->level_title) {
+    fprintf(file, "%ctitle: \"%s\"\n", LF_KEYVALUE_SIGNAL, board->level_title);
+  }
+  if (board->collection_title) {
+    fprintf(file, "%ccollection: \"%s\"\n", LF_KEYVALUE_SIGNAL,
+            board->collection_title);
+  }
+  if (board->level_number) {
+    fprintf(file, "%cnumber: %d\n", LF_KEYVALUE_SIGNAL, board->level_number);
   }
+  if (board->difficulty) {
+    fprintf(file, "%cdifficulty: %d\n", LF_KEYVALUE_SIGNAL, board->difficulty);
+  }
+  /* We rotate twice to fix a bug where the board is saved upside-down. */
+  serialize_graph(board->graph->rotate_r->rotate_r, board->arena->num_tiles,
+                  file);
 }
 
-
-void serialize_graph (Graph *g, FILE *file) {
-  clear_search(g);
-  Queue *q = new_queue();
-  QueueItem *qi = malloc(sizeof(QueueItem));
-  qi->g = g;
-  qi->refs = 0;
-  qi->whence = '\0';
-  qi->parent = NULL;
-  enqueue(q, qi);
-
-  while (q->first) {
-    QueueItem *qi = dequeue(q);
-    if (!qi->g->tile->search_flag) {
-      qi->g->tile->search_flag = 1;
-      serialize_node(qi, file, q);
-    }
+void serialize_board_binary (Board *board, FILE *file) {
+  /* Compile afresh, so the player is tile 0 wherever they have got to. */
+  FlatGraph *f = flat_compile(board->graph);
+  size_t n = f->num_tiles;
+
+  HblHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, HBL_MAGIC, sizeof(h.magic));
+  h.byte_order = HBL_BYTE_ORDER;
+  h.num_tiles = n;
+  h.difficulty = board->difficulty;
+  h.level_number = board->level_number;
+  h.title_length = board->level_title ? strlen(board->level_title) : 0;
+  h.collection_length =
+    board->collection_title ? strlen(board->collection_title) : 0;
+  fwrite(&h, sizeof(h), 1, file);
+  fwrite(f->neighbor, sizeof(uint32_t), 4 * n, file);
+
+  size_t size = HBL_CODES_SIZE(n);
+  uint8_t *codes = calloc(2, size);
+  for (size_t t = 0; t < n; t++) {
+    codes[t / 4] |= f->tile_type[t] << (2 * (t % 4));
+    codes[size + t / 4] |= f->agent[t] << (2 * (t % 4));
+  }
+  fwrite(codes, 1, 2 * size, file);
+  if (board->level_title) {
+    fwrite(board->level_title, 1, h.title_length, file);
+  }
+  if (board->collection_title) {
+    fwrite(board->collection_title, 1, h.collection_length, file);
   }
-}
 
-void serialize_board (Board *board, FILE *file) {
-  /* We rotate twice to fix a bug where the board is saved upside-down. */
-  serialize_graph(board->graph->rotate_r->rotate_r, file);
+  free(codes);
+  free_flat(f);
 }
@@ -25,4 +25,7 @@
 
 void serialize_board (Board *board, FILE *file);
 
+/* Write board as a binary level; see hbl.h. */
+void serialize_board_binary (Board *board, FILE *file);
+
 #endif /* __HYPERBAN__SERIALIZE_H */
@@ -17,15 +17,16 @@
  * with this program; if not, write to the Free Software Foundation, Inc., 51
  * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
-
 #include "sokoban.h"
 #include "types.h"
 #include "graph.h"
+#include "flat.h"
+#include "zobrist.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-static char sokoban_get_move_abbreviation (Move move, int is_push)
+char sokoban_get_move_abbreviation (Move move, int is_push)
 {
   char returnee = 32 * (1 - is_push); 
   /* If it's a push, we'll make it uppercase */
@@ -44,136 +45,238 @@ static char sokoban_get_move_abbreviation (Move move, int is_push)
     }
 }
 
+int sokoban_parse_move (char c, Move *move)
+{
+  switch (c)
+    {
+    case 'U': case 'u':
+      *move = MOVE_UP;
+      break;
+    case 'R': case 'r':
+      *move = MOVE_RIGHT;
+      break;
+    case 'D': case 'd':
+      *move = MOVE_DOWN;
+      break;
+    case 'L': case 'l':
+      *move = MOVE_LEFT;
+      break;
+    default:
+      return -1; /* illegal character */
+    }
+  return c < 'a'; /* uppercase is a push */
+}
+
+/* Moves done are moves[0 .. number_moves); those undone since, which
+   redo_move can take again, run on to moves_redo. */
 static int sokoban_update_board_data (Board *b, Move move, int is_push)
 {
-  b->number_moves++;
   if (!(b->moves))
-    return is_push; /* and don't do anything */
+    {
+      b->number_moves++;
+      return is_push; /* and don't do anything */
+    }
 
   char c = sokoban_get_move_abbreviation(move, is_push);
 
-  if (strlen(b->moves) >= b->moves_length - 1)
+  if ((size_t) b->number_moves >= b->moves_length)
     {
       b->moves_length *= 2;
       b->moves = realloc(b->moves, b->moves_length);
     }
-  strncat(b->moves, &c, 1); /* add a letter to the end */
+  b->moves[b->number_moves++] = c;
+  /* A new move can't be followed by old ones */
+  b->moves_redo = b->number_moves;
 
   return is_push;
 }
 
-int perform_move (Board *b, Move move)
+move_result_t perform_flat_move (const FlatGraph *f, char *agent,
+                                 uint32_t *player, int *unsolved,
+                                 uint64_t *hash, Move move)
 {
-  Graph *old = b->graph;
-  Graph *new = old;
-  for (char i = 0; i < move; i++)
-    new = new->rotate_r;
-  new = new->adjacent;
-  // Re-align orientation
-  for (char i = 0; i < (2 - move + 4) % 4; i++)
-    new = new->rotate_r;
-
-  if (new->tile->tile_type == TILE_TYPE_WALL)
+  uint32_t new = flat_step(f, *player, move);
+
+  if (new == FLAT_NONE || f->tile_type[FLAT_TILE(new)] == TILE_TYPE_WALL)
     return RESULT_NO_MOVE_POSSIBLE; /* No move allowed */
 
-  if (new->tile->agent == AGENT_NONE)
+  uint32_t t = FLAT_TILE(new);
+  if (agent[t] == AGENT_NONE)
     {
-      b->graph = new; /* Walk */
-      return sokoban_update_board_data(b, move, RESULT_MOVE);
+      *hash ^= ZOBRIST_PLAYER(FLAT_TILE(*player)) ^ ZOBRIST_PLAYER(t);
+      *player = new; /* Walk */
+      return RESULT_MOVE;
     }
 
   /* There's a box, so we need to figure out what's behind it */
 
-  Graph *behind = new;
-  for (char i = 0; i < move; i++)
-    behind = behind->rotate_r;
-  behind = behind->adjacent;
+  uint32_t behind = flat_step(f, new, move);
 
-  if (behind->tile->tile_type == TILE_TYPE_WALL)
+  if (behind == FLAT_NONE ||
+      f->tile_type[FLAT_TILE(behind)] == TILE_TYPE_WALL)
     return RESULT_NO_MOVE_POSSIBLE; /* Push blocked by wall. */
 
-  if (behind->tile->agent == AGENT_BOX)
+  uint32_t u = FLAT_TILE(behind);
+  if (agent[u] == AGENT_BOX)
     return RESULT_NO_MOVE_POSSIBLE; /* Push blocked by box. */
 
   /* There's nothing behind the box, so the box moves */
 
-  new->tile->agent = AGENT_NONE;
-  behind->tile->agent = AGENT_BOX;
+  agent[t] = AGENT_NONE;
+  agent[u] = AGENT_BOX;
 
-  if (new->tile->tile_type == TILE_TYPE_TARGET)
-    (b->unsolved)++;
+  if (f->tile_type[t] == TILE_TYPE_TARGET)
+    (*unsolved)++;
 
-  if (behind->tile->tile_type == TILE_TYPE_TARGET)
-    (b->unsolved)--;
+  if (f->tile_type[u] == TILE_TYPE_TARGET)
+    (*unsolved)--;
 
-  b->graph = new;
-  return sokoban_update_board_data(b, move, RESULT_PUSH); /* Push sucessful */
+  *hash ^= ZOBRIST_BOX(t) ^ ZOBRIST_BOX(u);
+  *hash ^= ZOBRIST_PLAYER(FLAT_TILE(*player)) ^ ZOBRIST_PLAYER(t);
+  *player = new;
+  return RESULT_PUSH; /* Push sucessful */
 }
 
+size_t replay_flat_moves (const FlatGraph *f, char *agent, uint32_t *player,
+                          int *unsolved, uint64_t *hash, const char *lurd,
+                          size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      Move move;
+      int is_push = sokoban_parse_move(lurd[i], &move);
+      if (is_push < 0)
+        return i;
 
+      /* A walk into a box would push it, so check before moving. */
+      uint32_t ahead = flat_step(f, *player, move);
+      if (ahead != FLAT_NONE
+          && (agent[FLAT_TILE(ahead)] == AGENT_BOX) != is_push)
+        return i;
 
-char unperform_move (Board *b)
+      if (perform_flat_move(f, agent, player, unsolved, hash, move)
+          == RESULT_NO_MOVE_POSSIBLE)
+        return i;
+    }
+  return n;
+}
+
+/* Make a move on the board without recording it. */
+static move_result_t sokoban_apply_move (Board *b, Move move)
 {
-  if (!(b->moves))
-    return '\0'; /* Undoing not set up correctly */
-  if (strlen(b->moves) == 0)
-    return '\0'; /* No moves have been made */
-  char c = b->moves[strlen(b->moves) - 1];
-  b->moves[strlen(b->moves) - 1] = '\0';
-  Graph *bluh = b->graph;
-  switch (c)
+  FlatGraph *f = b->flat;
+
+  move_result_t r = perform_flat_move(f, f->agent, &(b->player),
+                                      &(b->unsolved), &(b->hash), move);
+  if (r == RESULT_NO_MOVE_POSSIBLE)
+    return r;
+
+  /* Keep the pointer graph in step for the renderer */
+  if (r == RESULT_PUSH)
     {
-    case 'L': case 'l':
-      bluh = bluh->rotate_r;
-    case 'D': case 'd':
-      bluh = bluh->rotate_r;
-    case 'R': case 'r':
-      bluh = bluh->rotate_r;
-    case 'U': case 'u':
-      break;
-    default:
-      return '\0'; /* illegal character */
+      uint32_t behind = flat_step(f, b->player, move);
+      f->nodes[FLAT_TILE(b->player)]->tile->agent = AGENT_NONE;
+      f->nodes[FLAT_TILE(behind)]->tile->agent = AGENT_BOX;
     }
+  b->graph = flat_node(f, b->player);
 
-  /* First we check that we can walk backwards */
-  if (!(bluh->rotate_r->rotate_r->adjacent))
-    return '\0'; /* we can't */
+  return r;
+}
+
+move_result_t perform_move (Board *b, Move move)
+{
+  move_result_t r = sokoban_apply_move(b, move);
+  if (r == RESULT_NO_MOVE_POSSIBLE)
+    return r;
+
+  return sokoban_update_board_data(b, move, r);
+}
+
+int unperform_flat_move (const FlatGraph *f, char *agent, uint32_t *player,
+                         int *unsolved, uint64_t *hash, char c)
+{
+  Move move;
+  int is_push = sokoban_parse_move(c, &move);
+  if (is_push < 0)
+    return 0; /* illegal character */
 
+  uint32_t t = FLAT_TILE(*player);
+  uint32_t ahead = f->neighbor[(*player & ~3u) | ((*player + move) & 3)];
+  uint32_t back = f->neighbor[(*player & ~3u) | ((*player + move + 2) & 3)];
 
-  if (c < 'a') /* then it's uppercase */
+  /* First we check that we can walk backwards */
+  if (back == FLAT_NONE ||
+      f->tile_type[FLAT_TILE(back)] == TILE_TYPE_WALL ||
+      agent[FLAT_TILE(back)] == AGENT_BOX)
+    return 0; /* we can't */
+
+  if (is_push)
     {
-      if (bluh->adjacent->tile->agent != AGENT_BOX)
-        return '\0'; /* There's no box... */
+      if (ahead == FLAT_NONE || agent[FLAT_TILE(ahead)] != AGENT_BOX)
+        return 0; /* There's no box... */
+
+      uint32_t u = FLAT_TILE(ahead);
+      agent[u] = AGENT_NONE;
+      agent[t] = AGENT_BOX; /* pull box */
 
-      bluh->adjacent->tile->agent = AGENT_NONE;
-      bluh->tile->agent = AGENT_BOX; /* pull box */
+      if (f->tile_type[u] == TILE_TYPE_TARGET)
+        (*unsolved)++;
+      if (f->tile_type[t] == TILE_TYPE_TARGET)
+        (*unsolved)--;
 
-      if (bluh->adjacent->tile->tile_type == TILE_TYPE_TARGET)
-        (b->unsolved)++;
-      if (bluh->tile->tile_type == TILE_TYPE_TARGET)
-        (b->unsolved)--;
+      *hash ^= ZOBRIST_BOX(u) ^ ZOBRIST_BOX(t);
     }
-  
-  /* now step backwards */
-  b->graph = bluh->rotate_r->rotate_r->adjacent;
 
-  /* and spin until we're facing the right way */
-  /* note that the cases are in the OPPOSITE direction to as above! */
-  switch (c)
+  /* now step backwards, and spin until we're facing the right way */
+  *hash ^= ZOBRIST_PLAYER(t) ^ ZOBRIST_PLAYER(FLAT_TILE(back));
+  *player = (back & ~3u) | ((back + 4 - move) & 3);
+
+  return 1;
+}
+
+char unperform_move (Board *b)
+{
+  if (!(b->moves))
+    return '\0'; /* Undoing not set up correctly */
+  if (b->number_moves == 0)
+    return '\0'; /* No moves have been made */
+  char c = b->moves[b->number_moves - 1];
+
+  FlatGraph *f = b->flat;
+  uint32_t old = b->player;
+  if (!unperform_flat_move(f, f->agent, &(b->player), &(b->unsolved),
+                           &(b->hash), c))
+    return '\0';
+
+  /* Keep the pointer graph in step for the renderer */
+  if (c < 'a')
     {
-    case 'R': case 'r':
-      b->graph = b->graph->rotate_r;
-    case 'D': case 'd':
-      b->graph = b->graph->rotate_r;
-    case 'L': case 'l':
-      b->graph = b->graph->rotate_r;
-    case 'U': case 'u':
-      break;
+      Move move;
+      sokoban_parse_move(c, &move);
+      uint32_t ahead = f->neighbor[(old & ~3u) | ((old + move) & 3)];
+      f->nodes[FLAT_TILE(ahead)]->tile->agent = AGENT_NONE;
+      f->nodes[FLAT_TILE(old)]->tile->agent = AGENT_BOX;
     }
+  b->graph = flat_node(f, b->player);
 
-
-  /* one less move has been done */
+  /* one less move has been done; it stays in moves for redo_move */
   (b->number_moves)--;
 
   return c;
 }
+
+char redo_move (Board *b)
+{
+  if (!(b->moves) || (size_t) b->number_moves >= b->moves_redo)
+    return '\0'; /* Nothing has been undone */
+  char c = b->moves[b->number_moves];
+
+  Move move;
+  sokoban_parse_move(c, &move);
+  if (sokoban_apply_move(b, move) == RESULT_NO_MOVE_POSSIBLE)
+    return '\0';
+
+  (b->number_moves)++;
+
+  return c;
+}
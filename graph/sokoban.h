@@ -33,6 +33,32 @@ typedef enum {
 } move_result_t;
 
 move_result_t perform_move (Board *g, Move move);
+/* Undo the last move, returning it as recorded, or '\0' if there is none. */
 char unperform_move (Board *b);
+/* Make the last undone move again, as unperform_move returns it.  Any other
+   move forgets what was undone. */
+char redo_move (Board *b);
+
+/* The rules themselves, on a compiled graph with the state held by the
+   caller.  Board uses these on its own flat copy; searches can run them on
+   as many private copies of agent as they like. */
+move_result_t perform_flat_move (const FlatGraph *f, char *agent,
+                                 uint32_t *player, int *unsolved,
+                                 uint64_t *hash, Move move);
+/* Undo the move recorded as c.  Returns 0 if c can't be undone from here. */
+int unperform_flat_move (const FlatGraph *f, char *agent, uint32_t *player,
+                         int *unsolved, uint64_t *hash, char c);
+
+/* Make as many of the n moves in lurd as are legal, stopping at the first
+   that isn't, or that is a push written in lower case or a walk in upper
+   case.  Returns how many were made. */
+size_t replay_flat_moves (const FlatGraph *f, char *agent, uint32_t *player,
+                          int *unsolved, uint64_t *hash, const char *lurd,
+                          size_t n);
+
+char sokoban_get_move_abbreviation (Move move, int is_push);
+/* The inverse of sokoban_get_move_abbreviation: returns whether c is a
+   push, or -1 if it isn't a move at all. */
+int sokoban_parse_move (char c, Move *move);
 
 #endif /* __HYPERBAN__SOKOBAN_H */
@@ -22,11 +22,12 @@
 #define __HYPERBAN__TYPES_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
   char tile_type;
   char agent;
-  char search_flag;
+  uint32_t index; /* numbers the tiles of an arena densely from 0 */
 } Tile;
 
 enum {
@@ -71,16 +72,37 @@ typedef struct graph_t {
   Tile *tile;
 } Graph;
 
+/* See arena.h. */
+typedef struct {
+  struct arena_chunk_t *chunks; /* newest first */
+  uint32_t num_tiles; /* handed out by build_initial_node */
+} Arena;
+
+/* A Graph compiled down to arrays indexed by tile; see flat.h. */
+typedef struct {
+  size_t num_tiles;
+  uint32_t *neighbor; /* 4 * num_tiles packed entries */
+  char *tile_type;
+  char *agent;
+  Graph **nodes; /* the node each tile was first entered through */
+} FlatGraph;
+
 typedef struct {
   Graph* graph;
+  Arena *arena; /* holds every node and tile of graph */
+  FlatGraph *flat;
+  uint32_t player; /* flat entry for graph */
   int unsolved;
+  uint64_t hash; /* Zobrist key of the player and box positions */
+  uint64_t *dead; /* bit t: a box on flat tile t can never reach a target */
   int difficulty;
   int level_number;
   char *level_title;
   char *collection_title;
-  char *moves;
+  char *moves; /* not terminated; see number_moves and moves_redo */
   size_t moves_length;
   int number_moves;
+  size_t moves_redo; /* end of the moves undone that can be redone */
   char *filename;
   /* expand as needed */
 } Board;
@@ -0,0 +1,36 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "zobrist.h"
+#include "flat.h"
+
+uint64_t zobrist_board (Board *board)
+{
+  FlatGraph *f = board->flat;
+  if (!f)
+    return 0;
+
+  uint64_t hash = ZOBRIST_PLAYER(FLAT_TILE(board->player));
+  for (size_t i = 0; i < f->num_tiles; i++)
+    if (f->agent[i] == AGENT_BOX)
+      hash ^= ZOBRIST_BOX(i);
+
+  return hash;
+}
@@ -0,0 +1,47 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__ZOBRIST_H
+#define __HYPERBAN__ZOBRIST_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* Board.hash is the XOR of one key per box and one key for the player's
+   tile.  Keys are mixed from flat tile indices rather than looked up, so
+   they cost no memory traffic and agree between copies of the same
+   compiled board. */
+
+static inline uint64_t zobrist_mix (uint64_t x)
+{
+  /* splitmix64 finalizer */
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+#define ZOBRIST_BOX(t) zobrist_mix(2 * (uint64_t) (t) + 1)
+#define ZOBRIST_PLAYER(t) zobrist_mix(2 * (uint64_t) (t) + 2)
+
+/* Compute a compiled board's hash from scratch. */
+uint64_t zobrist_board (Board *board);
+
+#endif /* __HYPERBAN__ZOBRIST_H */
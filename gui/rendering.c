@@ -57,6 +57,9 @@ void render_graph(RendererParams *params, Graph *graph) {
   queue->points = new_squarepoints();
   *queue->points = *params->origin_square;
 
+  VisitSet *visits = params->visits;
+  visit_begin(visits);
+
   while (queue != NULL) {
     Graph *current = queue->val;
     SquarePoints *points = queue->points;
@@ -65,7 +68,7 @@ void render_graph(RendererParams *params, Graph *graph) {
     free(queue);
     queue = n;
 
-    current->tile->search_flag = 1;
+    visit_mark(visits, current->tile);
 
     params->draw_tile(params, points, current->tile);
 
@@ -74,25 +77,25 @@ void render_graph(RendererParams *params, Graph *graph) {
       continue;
     }
 
-    if (current->adjacent && !current->adjacent->tile->search_flag) {
+    if (current->adjacent && !visit_seen(visits, current->adjacent->tile)) {
       add_queue(&queue, &queue_end, ROTATE_B(current->adjacent),
           move_square(points, MOVE_UP), d+1);
     }
 
     if (current->rotate_r->adjacent &&
-        !current->rotate_r->adjacent->tile->search_flag) {
+        !visit_seen(visits, current->rotate_r->adjacent->tile)) {
       add_queue(&queue, &queue_end, current->rotate_r->adjacent->rotate_r,
           move_square(points, MOVE_RIGHT), d+1);
     }
 
     if (ROTATE_B(current)->adjacent &&
-        !ROTATE_B(current)->adjacent->tile->search_flag) {
+        !visit_seen(visits, ROTATE_B(current)->adjacent->tile)) {
       add_queue(&queue, &queue_end, ROTATE_B(current)->adjacent,
           move_square(points, MOVE_DOWN), d+1);
     }
 
     if (ROTATE_L(current)->adjacent &&
-        !ROTATE_L(current)->adjacent->tile->search_flag) {
+        !visit_seen(visits, ROTATE_L(current)->adjacent->tile)) {
       add_queue(&queue, &queue_end, ROTATE_L(ROTATE_L(current)->adjacent),
           move_square(points, MOVE_LEFT), d+1);
     }
@@ -22,6 +22,7 @@
 #define __HYPERBAN_RENDERING_H
 
 #include "../graph/types.h"
+#include "../graph/graph.h"
 #include "matrix.h"
 
 #define RENDERING_MAX_DIST 7
@@ -41,6 +42,7 @@ struct renderer_params_t {
   HyperbolicProjection projection;
   SquarePoints *origin_square;
   void *data; // In practice this is a cairo_t*
+  VisitSet *visits; // Scratch space for render_graph
 };
 
 typedef struct renderer_params_t RendererParams;
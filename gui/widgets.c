@@ -34,10 +34,12 @@
 #include "../graph/level.h"
 #include "../graph/sokoban.h"
 #include "../graph/board.h"
+#include "../graph/audit.h"
 #include "./rendering.h"
 #include "./cairo_helper.h"
 #include "../graph/generator.h"
 #include "../graph/serialize.h"
+#include "../graph/hbl.h"
 
 static double get_time(void) {
   struct timespec now;
@@ -51,6 +53,7 @@ void free_renderer_options(RendererWidgetOptions *o) {
     free_board(o->board);
   if (o->pixmap)
     g_object_unref(o->pixmap);
+  visit_destroy(&o->visits);
   free(o);
 }
 
@@ -103,7 +106,8 @@ static void draw_tile(RendererParams *params, SquarePoints *points,
 }
 
 static void renderer_draw(cairo_t *cr, double width, double height,
-    Graph* graph, HyperbolicProjection projection, Move m, double frame) {
+    Graph* graph, HyperbolicProjection projection, Move m, double frame,
+    VisitSet *visits) {
   cairo_set_source_rgb(cr, 1, 1, 1);
   cairo_paint(cr);
 
@@ -124,8 +128,6 @@ static void renderer_draw(cairo_t *cr, double width, double height,
   cairo_set_source_rgb(cr, 0, 0, 0);
   cairo_stroke(cr);
 
-  clear_search(graph);
-
   SquarePoints *origin = new_squarepoints();
   *origin = origin_square;
 
@@ -151,7 +153,8 @@ static void renderer_draw(cairo_t *cr, double width, double height,
     radius,
     projection,
     origin,
-    cr
+    cr,
+    visits
   };
 
   cairo_set_line_width(cr, 1/params.scale);
@@ -168,7 +171,8 @@ static void renderer_draw(cairo_t *cr, double width, double height,
 
 static void set_labels(RendererWidgetOptions *opts) {
   char *t;
-  t = g_strdup_printf(BOXES_TEXT, opts->board->unsolved);
+  t = g_strdup_printf(audit_board_stuck(opts->board) ? BOXES_STUCK_TEXT :
+      BOXES_TEXT, opts->board->unsolved);
   gtk_label_set_text(opts->boxes_label, t);
   g_free(t);
 
@@ -211,6 +215,19 @@ static gpointer draw_thread(gpointer ptr) {
     case 'd': case 'D':
       opts->move++;
     }
+  } else if (opts->move == -3) {
+    res = (redo_move(opts->board));
+    opts->move = -1;
+    switch(res) {
+    case 'l': case 'L':
+      opts->move++;
+    case 'd': case 'D':
+      opts->move++;
+    case 'r': case 'R':
+      opts->move++;
+    case 'u': case 'U':
+      opts->move++;
+    }
   }
   if (res && opts->animation) {
     double start = get_time();
@@ -223,7 +240,7 @@ static gpointer draw_thread(gpointer ptr) {
           RENDERER_ANIMATION_TIME);
 
       renderer_draw(cr, width / opts->scale, height / opts->scale, oldpos,
-          opts->projection, opts->move, frame);
+          opts->projection, opts->move, frame, &opts->visits);
 
       cairo_destroy(cr);
 
@@ -258,7 +275,7 @@ static gpointer draw_thread(gpointer ptr) {
   cairo_t *cr = cairo_create(cst);
 
   renderer_draw(cr, width / opts->scale, height / opts->scale,
-      opts->board->graph, opts->projection, 0, 0);
+      opts->board->graph, opts->projection, 0, 0, &opts->visits);
 
   cairo_destroy(cr);
 
@@ -344,10 +361,14 @@ static gboolean on_renderer_key_press_event(GtkWidget *widget,
     if (!opts->editing)
       m = -2;
     break;
+  case KEY_REDO:
+    if (!opts->editing)
+      m = -3;
+    break;
   case KEY_MAKE_FLOOR:
     if (opts->editing) {
       opts->board->graph->adjacent->tile->tile_type = TILE_TYPE_SPACE;
-      build_wall_in(opts->board->graph->adjacent);
+      build_wall_in(opts->board->arena, opts->board->graph->adjacent);
     }
     break;
   case KEY_MAKE_WALL:
@@ -367,7 +388,7 @@ static gboolean on_renderer_key_press_event(GtkWidget *widget,
     if (opts->editing) {
       if (opts->board->graph->adjacent->tile->agent != AGENT_BOX) {
         opts->board->graph->adjacent->tile->tile_type = TILE_TYPE_SPACE;
-        build_wall_in(opts->board->graph->adjacent);
+        build_wall_in(opts->board->arena, opts->board->graph->adjacent);
         opts->board->graph->adjacent->tile->agent = AGENT_BOX;
         opts->board->unsolved++;
       }
@@ -384,13 +405,16 @@ static gboolean on_renderer_key_press_event(GtkWidget *widget,
   case KEY_MAKE_TARGET:
     if (opts->editing) {
       opts->board->graph->adjacent->tile->tile_type = TILE_TYPE_TARGET;
-      build_wall_in(opts->board->graph->adjacent);
+      build_wall_in(opts->board->arena, opts->board->graph->adjacent);
     }
     break;
   case KEY_SAVE:
     if (opts->editing) {
       FILE *f = fopen(opts->board->filename, "w");
-      serialize_board(opts->board, f);
+      if (hbl_is_binary(opts->board->filename))
+        serialize_board_binary(opts->board, f);
+      else
+        serialize_board(opts->board, f);
       fclose(f);
     }
     break;
@@ -401,6 +425,10 @@ static gboolean on_renderer_key_press_event(GtkWidget *widget,
     return FALSE;
   }
 
+  /* Edits go straight to the pointer graph, so recompile the flat copy. */
+  if (opts->editing && m < 0)
+    board_compile(opts->board);
+
   animate_move(opts, m);
   return FALSE;
 }
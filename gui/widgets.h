@@ -26,6 +26,7 @@
 #include "./rendering.h"
 #include "../graph/build.h"
 #include "../graph/types.h"
+#include "../graph/graph.h"
 
 /* Yes, I am aware this should really just extend EventBox */
 struct renderer_widget_options_t {
@@ -41,6 +42,7 @@ struct renderer_widget_options_t {
   GtkLabel *moves_label;
   GtkLabel *boxes_label;
   GtkWidget *help;
+  VisitSet visits; // used by the draw thread
 };
 
 typedef struct renderer_widget_options_t RendererWidgetOptions;
@@ -30,11 +30,13 @@
 #include "graph/sokoban.h"
 #include "graph/board.h"
 #include "graph/generator.h"
+#include "graph/hbl.h"
 
 static const char *help_text =
 "General: \n"
 "  Move: Arrow Keys\n"
 "  Undo: Backspace\n"
+"  Redo: r\n"
 "  Show/Hide Help: h\n"
 "\n"
 "Editing: \n"
@@ -128,6 +130,16 @@ static RendererWidgetOptions *parse_args(int argc, char *argv[]) {
 
   if (random) {
     board = generate_board(NULL);
+    if (board == NULL) {
+      fprintf(stderr, "Could not generate a level.\n");
+      goto FAIL;
+    }
+  } else if (hbl_is_binary(levels[0])) {
+    level = levels[0];
+    board = hbl_load(level);
+    if (board == NULL)
+      goto FAIL;
+    board->filename = strdup(level);
   } else {
     level = levels[0];
     FILE* levelfh = fopen(level, "r");
@@ -171,6 +183,7 @@ static RendererWidgetOptions *parse_args(int argc, char *argv[]) {
   opts->animation = animation;
   opts->editing = editing;
   opts->scale = scale;
+  visit_init(&opts->visits);
 
   return opts;
 FAIL:
@@ -29,6 +29,7 @@
 #define KEY_LEFT GDK_KEY_Left
 #define KEY_DOWN GDK_KEY_Down
 #define KEY_UNDO GDK_KEY_BackSpace
+#define KEY_REDO GDK_KEY_r
 
 #define KEY_HELP GDK_KEY_h
 
@@ -58,6 +59,7 @@
 #define RENDERER_TITLE "Hyperban"
 
 #define BOXES_TEXT "Boxes Left: %d"
+#define BOXES_STUCK_TEXT "Boxes Left: %d (stuck, undo!)"
 
 #define MOVES_TEXT "Moves Taken: %d"
 
@@ -0,0 +1,237 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "solve.h"
+#include "graph/level.h"
+#include "graph/board.h"
+#include "graph/hbl.h"
+#include "solver/explore.h"
+#include "solver/solver.h"
+
+static Board *load_board(const char *level) {
+  if (hbl_is_binary(level)) {
+    Board *board = hbl_load(level);
+    if (board != NULL)
+      board->filename = strdup(level);
+    return board;
+  }
+
+  FILE* levelfh = fopen(level, "r");
+  if (levelfh == NULL) {
+    perror("Could not open level");
+    return NULL;
+  }
+
+  SavedTile *map = NULL;
+  ConfigOption *cfg = NULL;
+  level_parse_file(levelfh, &map, &cfg);
+
+  fclose(levelfh);
+
+  if ((map == NULL) || (cfg == NULL)) {
+    fprintf(stderr, "Could not succesfully parse %s.\n", level);
+    free(map);
+    free(cfg);
+    return NULL;
+  }
+  Board *board = board_assemble_full(map, cfg);
+  for (size_t i = 0; map[i].path; i++)
+    free(map[i].path);
+  free(map);
+  free(cfg);
+  if (board == NULL) {
+    fprintf(stderr, "Could not succesfully create board from %s.\n", level);
+    return NULL;
+  }
+  board->filename = strdup(level);
+  return board;
+}
+
+static int solve_level(const char *level, const SolverParams *params,
+    int quiet) {
+  Board *board = load_board(level);
+  if (board == NULL) return 0;
+
+  SolverResult *result = solve_board(board, params);
+
+  int solved = (result->status == SOLVER_SOLVED);
+  switch (result->status) {
+  case SOLVER_SOLVED:
+    printf(SOLVED_TEXT, level, result->pushes, result->moves);
+    if (!quiet)
+      printf("%s\n", result->solution);
+    /* The board is still at the start; make sure the solution works. */
+    if (board_replay(board, result->solution, result->moves) != result->moves
+        || board->unsolved) {
+      fprintf(stderr, "%s: the solution found does not work!\n", level);
+      solved = 0;
+    }
+    break;
+  case SOLVER_UNSOLVABLE:
+    printf(UNSOLVABLE_TEXT, level);
+    break;
+  case SOLVER_LIMIT:
+    printf(LIMIT_TEXT, level);
+    break;
+  case SOLVER_NO_MEMORY:
+    fprintf(stderr, NO_MEMORY_TEXT, level);
+    free_solver_result(result);
+    free_board(board);
+    return 0;
+  }
+  printf(STATS_TEXT, level, result->nodes_expanded, result->seconds,
+      result->seconds > 0 ? result->nodes_expanded / result->seconds : 0);
+
+  free_solver_result(result);
+  free_board(board);
+  return solved;
+}
+
+static int explore_level(const char *level, const SolverParams *params) {
+  Board *board = load_board(level);
+  if (board == NULL) return 0;
+
+  ExploreResult *result = explore_board(board, params->max_nodes,
+      params->table_size);
+  free_board(board);
+  if (result == NULL) return 0;
+
+  for (size_t d = 0; d < result->depth; d++)
+    printf(LAYER_TEXT, level, result->states[d], d, result->solved[d]);
+  if (result->finished)
+    printf(EXPLORED_TEXT, level, result->total, result->seconds);
+  else
+    printf(LIMIT_TEXT, level);
+
+  int finished = result->finished;
+  free_explore_result(result);
+  return finished;
+}
+
+/* Check the solution on the next line of standard input against level. */
+static int check_level(const char *level, char **line, size_t *size) {
+  ssize_t length = getline(line, size, stdin);
+  if (length < 0) {
+    fprintf(stderr, "%s: no solution to check\n", level);
+    return 0;
+  }
+  while (length > 0 && ((*line)[length - 1] == '\n' ||
+        (*line)[length - 1] == '\r'))
+    length--;
+
+  Board *board = load_board(level);
+  if (board == NULL) return 0;
+
+  size_t done = board_replay(board, *line, length);
+  int solved = 0;
+  if (done < (size_t) length)
+    printf(ILLEGAL_TEXT, level, done + 1);
+  else if (board->unsolved)
+    printf(UNFINISHED_TEXT, level, board->unsolved);
+  else {
+    printf(CHECKED_TEXT, level, done);
+    solved = 1;
+  }
+
+  free_board(board);
+  return solved;
+}
+
+int main(int argc, char *argv[]) {
+  SolverParams params = {
+    SOLVER_DEFAULT_MAX_NODES,
+    SOLVER_DEFAULT_TABLE_SIZE,
+    SOLVER_ASTAR,
+    SOLVER_DEFAULT_THREADS
+  };
+  size_t megabytes;
+  int quiet = 0;
+  int check = 0;
+  int explore = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:m:j:bdeqch")) != -1) {
+    switch (opt) {
+    case 'n':
+      if (!sscanf(optarg, "%zu", &params.max_nodes)) {
+        fprintf(stderr, "Could not parse max nodes!\n");
+        return 2;
+      }
+      break;
+    case 'm':
+      if (!sscanf(optarg, "%zu", &megabytes) || megabytes == 0) {
+        fprintf(stderr, "Could not parse table size!\n");
+        return 2;
+      }
+      params.table_size = megabytes << 20;
+      break;
+    case 'j':
+      if (!sscanf(optarg, "%zu", &params.threads) || params.threads == 0) {
+        fprintf(stderr, "Could not parse threads!\n");
+        return 2;
+      }
+      break;
+    case 'b':
+      params.algorithm = SOLVER_BFS;
+      break;
+    case 'd':
+      params.algorithm = SOLVER_BIDIRECTIONAL;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    case 'c':
+      check = 1;
+      break;
+    case 'e':
+      explore = 1;
+      break;
+    case 'h':
+      printf(SOLVE_USAGE, argv[0]);
+      return 0;
+    default:
+      fprintf(stderr, SOLVE_USAGE, argv[0]);
+      return 2;
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, SOLVE_USAGE, argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  char *line = NULL;
+  size_t line_size = 0;
+  for (int i = optind; i < argc; i++) {
+    if (check ? !check_level(argv[i], &line, &line_size)
+        : explore ? !explore_level(argv[i], &params)
+        : !solve_level(argv[i], &params, quiet))
+      failed = 1;
+  }
+  free(line);
+
+  return failed;
+}
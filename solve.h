@@ -0,0 +1,60 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN_SOLVE_H
+#define __HYPERBAN_SOLVE_H
+
+#define SOLVE_USAGE \
+"Usage: %s [-b | -d] [-q] [-c | -e] [-n MAX_NODES] [-m MEGABYTES]\n" \
+"       [-j THREADS] LEVEL...\n" \
+"Search every LEVEL for a push-optimal solution.\n" \
+"\n" \
+"  -n MAX_NODES  give up on a level after expanding this many states\n" \
+"  -m MEGABYTES  size of the transposition table (default 64)\n" \
+"  -j THREADS    search with this many threads (default 1); what is\n" \
+"                found is the same whatever the number\n" \
+"  -b            search breadth-first, without estimating the pushes\n" \
+"                left; slower, but checks the estimate\n" \
+"  -d            search breadth-first from both ends, pushing from the\n" \
+"                start and pulling back from the goals; every state\n" \
+"                reached is kept, in tables that grow as needed rather\n" \
+"                than in the -m table\n" \
+"  -q            don't print solutions\n" \
+"  -c            instead of searching, check the solutions on standard\n" \
+"                input, one LURD line for each LEVEL\n" \
+"  -e            instead of searching, count every state reachable, by\n" \
+"                pushes, keeping them in temporary files; -n limits the\n" \
+"                states and -m is the memory for sorting them\n" \
+"  -h            show this help\n" \
+"\n" \
+"Exits with status 1 if any level could not be solved.\n"
+
+#define SOLVED_TEXT "%s: solved in %zu pushes, %zu moves\n"
+#define UNSOLVABLE_TEXT "%s: no solution exists\n"
+#define LIMIT_TEXT "%s: gave up\n"
+#define NO_MEMORY_TEXT "%s: no memory for the transposition table\n"
+#define CHECKED_TEXT "%s: solution checks out, %zu moves\n"
+#define ILLEGAL_TEXT "%s: move %zu is illegal\n"
+#define UNFINISHED_TEXT "%s: %d boxes left off target\n"
+#define LAYER_TEXT "%s: %zu states after %zu pushes, %zu solved\n"
+#define EXPLORED_TEXT "%s: %zu states in all, counted in %.3fs\n"
+#define STATS_TEXT "%s: %zu nodes expanded in %.3fs (%.0f nodes/s)\n"
+
+#endif /* __HYPERBAN_SOLVE_H */
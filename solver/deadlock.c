@@ -0,0 +1,288 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "deadlock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../graph/audit.h"
+#include "../graph/flat.h"
+#include "../graph/zobrist.h"
+#include "reach.h"
+
+struct deadlock_t {
+  const Board *board;
+  const FlatGraph *flat;
+  /* Per-tile marks: a tile is marked when its stamp is the current epoch
+     for that purpose. */
+  uint32_t epoch;
+  uint32_t *wall; /* boxes the freeze test is treating as walls */
+  uint32_t wall_epoch;
+  Reach *reach; /* tiles the player can get to */
+  uint32_t *corral; /* tiles of the corral, and the boxes on its fence */
+  uint32_t *queue;
+  uint32_t *stack; /* boxes marked as walls, so a failed guess can be undone */
+  size_t stack_height;
+  /* The corral search */
+  char *agent; /* the fence boxes of the state being expanded, and no others */
+  uint32_t *states; /* the player's tile then the boxes' tiles, per state */
+  size_t num_boxes;
+  uint64_t seen[2 * DEADLOCK_CORRAL_STATES]; /* open addressing; 0 is empty */
+};
+
+Deadlock *new_deadlock(const Board *board) {
+  const FlatGraph *f = board->flat;
+  Deadlock *dl = calloc(1, sizeof(Deadlock));
+  dl->board = board;
+  dl->flat = f;
+  dl->wall = calloc(f->num_tiles, sizeof(uint32_t));
+  dl->reach = new_reach(f);
+  dl->corral = calloc(f->num_tiles, sizeof(uint32_t));
+  dl->queue = malloc(f->num_tiles * sizeof(uint32_t));
+  dl->stack = malloc(f->num_tiles * sizeof(uint32_t));
+  dl->agent = malloc(f->num_tiles);
+  memset(dl->agent, AGENT_NONE, f->num_tiles);
+  dl->states = NULL;
+  return dl;
+}
+
+void free_deadlock(Deadlock *dl) {
+  free(dl->wall);
+  free_reach(dl->reach);
+  free(dl->corral);
+  free(dl->queue);
+  free(dl->stack);
+  free(dl->agent);
+  free(dl->states);
+  free(dl);
+}
+
+static uint32_t next_epoch(Deadlock *dl) {
+  if (++dl->epoch == 0) {
+    size_t n = dl->flat->num_tiles;
+    memset(dl->wall, 0, n * sizeof(uint32_t));
+    memset(dl->corral, 0, n * sizeof(uint32_t));
+    dl->epoch = 1;
+  }
+  return dl->epoch;
+}
+
+/* Whether entry is off the graph or a wall. */
+static int blocks(const FlatGraph *f, uint32_t entry) {
+  return entry == FLAT_NONE || f->tile_type[FLAT_TILE(entry)] == TILE_TYPE_WALL;
+}
+
+static int frozen(Deadlock *dl, const char *agent, uint32_t t,
+    int *off_target);
+
+/* Whether the box on t can't be pushed from edge d to the opposite edge,
+   or back.  Neighbouring boxes are tested in turn, with t as a wall. */
+static int axis_blocked(Deadlock *dl, const char *agent, uint32_t t, int d,
+    int *off_target) {
+  const FlatGraph *f = dl->flat;
+  uint32_t a = f->neighbor[4 * t + d];
+  uint32_t b = f->neighbor[4 * t + d + 2];
+  if (blocks(f, a) || blocks(f, b))
+    return 1;
+  a = FLAT_TILE(a);
+  b = FLAT_TILE(b);
+  if (audit_is_dead(dl->board, a) && audit_is_dead(dl->board, b))
+    return 1;
+  if (agent[a] == AGENT_BOX && (dl->wall[a] == dl->wall_epoch ||
+        frozen(dl, agent, a, off_target)))
+    return 1;
+  if (agent[b] == AGENT_BOX && (dl->wall[b] == dl->wall_epoch ||
+        frozen(dl, agent, b, off_target)))
+    return 1;
+  return 0;
+}
+
+static int frozen(Deadlock *dl, const char *agent, uint32_t t,
+    int *off_target) {
+  size_t height = dl->stack_height;
+  dl->wall[t] = dl->wall_epoch;
+  dl->stack[dl->stack_height++] = t;
+
+  int off = dl->flat->tile_type[t] != TILE_TYPE_TARGET;
+  if (axis_blocked(dl, agent, t, 0, &off) &&
+      axis_blocked(dl, agent, t, 1, &off)) {
+    *off_target |= off;
+    return 1;
+  }
+
+  /* Everything decided while t was taken for a wall is suspect */
+  while (dl->stack_height > height)
+    dl->wall[dl->stack[--dl->stack_height]] = 0;
+  return 0;
+}
+
+/* Mark the corral around tile start, which the player can't reach, and
+   collect the boxes on its fence as the first state of the search. */
+static void find_corral(Deadlock *dl, const char *agent, uint32_t player,
+    uint32_t start, uint32_t epoch) {
+  const FlatGraph *f = dl->flat;
+  size_t head = 0, tail = 0;
+  dl->corral[start] = epoch;
+  dl->queue[tail++] = start;
+  dl->num_boxes = 0;
+  dl->states = realloc(dl->states, sizeof(uint32_t));
+  dl->states[0] = player;
+  while (head < tail) {
+    uint32_t t = dl->queue[head++];
+    for (int d = 0; d < 4; d++) {
+      uint32_t n = f->neighbor[4 * t + d];
+      if (blocks(f, n))
+        continue;
+      n = FLAT_TILE(n);
+      if (dl->corral[n] == epoch)
+        continue;
+      dl->corral[n] = epoch;
+      if (agent[n] == AGENT_BOX) {
+        dl->states = realloc(dl->states,
+            (++dl->num_boxes + 1) * sizeof(uint32_t));
+        dl->states[dl->num_boxes] = n;
+      } else {
+        dl->queue[tail++] = n;
+      }
+    }
+  }
+}
+
+static uint64_t state_key(const uint32_t *state, size_t num_boxes) {
+  uint64_t key = ZOBRIST_PLAYER(state[0]);
+  for (size_t i = 1; i <= num_boxes; i++)
+    key ^= ZOBRIST_BOX(state[i]);
+  return key ? key : 1;
+}
+
+/* Returns 1 if key was already there. */
+static int remember(Deadlock *dl, uint64_t key) {
+  size_t mask = 2 * DEADLOCK_CORRAL_STATES - 1;
+  for (size_t i = key & mask;; i = (i + 1) & mask) {
+    if (dl->seen[i] == key)
+      return 1;
+    if (dl->seen[i] == 0) {
+      dl->seen[i] = key;
+      return 0;
+    }
+  }
+}
+
+/* Search the corral found by find_corral with only its fence boxes on the
+   board.  Returns 1 if they can't all be got onto targets, and 0 if they
+   can or the search ran too long to tell. */
+static int corral_lost(Deadlock *dl) {
+  const FlatGraph *f = dl->flat;
+  size_t k = dl->num_boxes, stride = k + 1;
+  size_t num_states = 1;
+  int lost = 1;
+
+  if (k > DEADLOCK_CORRAL_BOXES)
+    return 0;
+  dl->states = realloc(dl->states,
+      DEADLOCK_CORRAL_STATES * stride * sizeof(uint32_t));
+  memset(dl->seen, 0, sizeof(dl->seen));
+  remember(dl, state_key(dl->states, k));
+
+  for (size_t i = 0; i < num_states && lost; i++) {
+    uint32_t *state = dl->states + i * stride;
+    const uint64_t *reach = reach_bits(dl->reach);
+    size_t on_target = 0;
+    for (size_t j = 1; j <= k; j++) {
+      dl->agent[state[j]] = AGENT_BOX;
+      on_target += f->tile_type[state[j]] == TILE_TYPE_TARGET;
+    }
+
+    if (on_target == k)
+      lost = 0;
+    else
+      reach_flood(dl->reach, dl->agent, state[0]);
+
+    for (size_t j = 1; j <= k && lost; j++) {
+      uint32_t b = state[j];
+      for (int d = 0; d < 4; d++) {
+        uint32_t p = f->neighbor[4 * b + d];
+        uint32_t q = f->neighbor[4 * b + ((d + 2) & 3)];
+        if (p == FLAT_NONE || !REACH_HAS(reach, FLAT_TILE(p)) ||
+            blocks(f, q))
+          continue;
+        q = FLAT_TILE(q);
+        if (dl->agent[q] == AGENT_BOX || audit_is_dead(dl->board, q))
+          continue;
+
+        if (num_states == DEADLOCK_CORRAL_STATES) {
+          lost = 0; /* too big to be sure */
+          break;
+        }
+        uint32_t *child = dl->states + num_states * stride;
+        memcpy(child, state, stride * sizeof(uint32_t));
+        child[0] = b;
+        child[j] = q;
+        if (!remember(dl, state_key(child, k)))
+          num_states++;
+      }
+    }
+
+    for (size_t j = 1; j <= k; j++)
+      dl->agent[state[j]] = AGENT_NONE;
+  }
+  return lost;
+}
+
+int deadlock_after_push(Deadlock *dl, const char *agent, uint32_t player,
+    uint32_t box) {
+  const FlatGraph *f = dl->flat;
+
+  int off_target = 0;
+  dl->wall_epoch = next_epoch(dl);
+  dl->stack_height = 0;
+  if (frozen(dl, agent, box, &off_target) && off_target)
+    return 1;
+
+  /* A corral the push has just closed will be next to the box.  Find
+     where they start before searching, which moves the player about. */
+  reach_flood(dl->reach, agent, FLAT_TILE(player));
+  const uint64_t *reach = reach_bits(dl->reach);
+  uint32_t starts[4];
+  int num_starts = 0;
+  for (int d = 0; d < 4; d++) {
+    uint32_t n = f->neighbor[4 * box + d];
+    if (blocks(f, n))
+      continue;
+    n = FLAT_TILE(n);
+    if (agent[n] != AGENT_BOX && !REACH_HAS(reach, n))
+      starts[num_starts++] = n;
+  }
+
+  uint32_t epochs[4];
+  for (int i = 0; i < num_starts; i++) {
+    int known = 0; /* part of a corral already searched */
+    for (int j = 0; j < i; j++)
+      known |= dl->corral[starts[i]] == epochs[j];
+    epochs[i] = known ? dl->corral[starts[i]] : next_epoch(dl);
+    if (known)
+      continue;
+    find_corral(dl, agent, FLAT_TILE(player), starts[i], epochs[i]);
+    if (corral_lost(dl))
+      return 1;
+  }
+  return 0;
+}
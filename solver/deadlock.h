@@ -0,0 +1,55 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__DEADLOCK_H
+#define __HYPERBAN__DEADLOCK_H
+
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* Deadlocks that only show up once boxes are in play, checked after each
+   push.  Dead squares (see audit_board) are assumed to be pruned already.
+
+   A box is frozen when it can be pushed along neither of its tile's two
+   axes; an axis runs from an edge to the opposite edge, which is the way a
+   push carries a box across a tile.  A frozen box off its target ends the
+   game.
+
+   A corral is a region the player can't get into, fenced off by boxes.
+   Any solution has to get every box on its fence onto a target, and it
+   can only do that more easily with the other boxes gone, so if even that
+   is impossible the position is lost.  That smaller problem is searched
+   for a bounded number of states, and only for small fences. */
+
+typedef struct deadlock_t Deadlock;
+
+Deadlock *new_deadlock (const Board *board);
+void free_deadlock (Deadlock *dl);
+
+/* Returns 1 if the position in agent, with the player on entry player just
+   having pushed a box onto tile box, can't be solved. */
+int deadlock_after_push (Deadlock *dl, const char *agent, uint32_t player,
+                         uint32_t box);
+
+#define DEADLOCK_CORRAL_STATES 64
+#define DEADLOCK_CORRAL_BOXES 4
+
+#endif /* __HYPERBAN__DEADLOCK_H */
@@ -0,0 +1,489 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* for qsort_r */
+#define _GNU_SOURCE
+
+#include "explore.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../graph/flat.h"
+#include "pushes.h"
+#include "rank.h"
+
+/* A sorted file of records free of repeats.  A run made by merging
+   EXPLORE_MERGE_WAYS runs of one level is a level higher. */
+typedef struct {
+  FILE *fh;
+  unsigned level;
+} Run;
+
+/* A record is k box tiles in increasing order, then the player's tile. */
+typedef struct explorer_t {
+  const FlatGraph *flat;
+  Pushes *pushes;
+  char *agent;
+  size_t k;
+  size_t size; /* of a record in bytes */
+  /* what to do with each child found */
+  int (*emit) (struct explorer_t *e, const uint32_t *record);
+  /* when states are sorted in files */
+  uint32_t *buffer;
+  size_t num_buffered;
+  size_t buffer_records;
+  Run *runs; /* oldest first, so their levels never go up */
+  size_t num_runs;
+  size_t runs_size;
+  /* when states are bits */
+  const Ranker *ranker;
+  uint64_t *seen;
+  FILE *next;
+  size_t count;
+  size_t num_solved;
+} Explorer;
+
+/* A sorted file of records, read one at a time. */
+typedef struct {
+  FILE *fh;
+  uint32_t *record;
+  int live;
+} Stream;
+
+/* Runs being merged: a heap of the streams with records left, least
+   record on top. */
+typedef struct {
+  Stream *streams;
+  size_t *heap;
+  size_t num_heap;
+  size_t size; /* of a record */
+} Merge;
+
+static double get_time(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* size points at the record size, passed along by qsort_r */
+static int compare(const void *a, const void *b, void *size) {
+  return memcmp(a, b, *(const size_t *) size);
+}
+
+static void stream_next(Stream *s, size_t size) {
+  s->live = fread(s->record, size, 1, s->fh) == 1;
+}
+
+static void stream_open(Stream *s, FILE *fh, size_t size) {
+  s->fh = fh;
+  s->record = malloc(size);
+  rewind(fh);
+  stream_next(s, size);
+}
+
+static int merge_less(const Merge *m, size_t a, size_t b) {
+  return memcmp(m->streams[m->heap[a]].record, m->streams[m->heap[b]].record,
+      m->size) < 0;
+}
+
+static void merge_sift_down(Merge *m, size_t i) {
+  for (;;) {
+    size_t least = i, l = 2 * i + 1, r = 2 * i + 2;
+    if (l < m->num_heap && merge_less(m, l, least))
+      least = l;
+    if (r < m->num_heap && merge_less(m, r, least))
+      least = r;
+    if (least == i)
+      return;
+    size_t swap = m->heap[i];
+    m->heap[i] = m->heap[least];
+    m->heap[least] = swap;
+    i = least;
+  }
+}
+
+static void merge_open(Merge *m, const Run *runs, size_t n, size_t size) {
+  m->streams = malloc(n * sizeof(Stream));
+  m->heap = malloc(n * sizeof(size_t));
+  m->num_heap = 0;
+  m->size = size;
+  for (size_t i = 0; i < n; i++) {
+    stream_open(&m->streams[i], runs[i].fh, size);
+    if (m->streams[i].live)
+      m->heap[m->num_heap++] = i;
+  }
+  for (size_t i = m->num_heap / 2; i-- > 0; )
+    merge_sift_down(m, i);
+}
+
+/* Take the least record left into record.  Returns 0 once there are
+   none. */
+static int merge_next(Merge *m, uint32_t *record) {
+  if (m->num_heap == 0)
+    return 0;
+  Stream *s = &m->streams[m->heap[0]];
+  memcpy(record, s->record, m->size);
+  stream_next(s, m->size);
+  if (!s->live)
+    m->heap[0] = m->heap[--m->num_heap];
+  merge_sift_down(m, 0);
+  return 1;
+}
+
+/* Close the runs merged, which are spent. */
+static void merge_close(Merge *m, const Run *runs, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    fclose(runs[i].fh);
+    free(m->streams[i].record);
+  }
+  free(m->streams);
+  free(m->heap);
+}
+
+/* Merge the last n runs into one, a level above the highest of them.
+   Runs are free of repeats, but not of each other's. */
+static int collapse_runs(Explorer *e, size_t n) {
+  Run *runs = e->runs + e->num_runs - n;
+  FILE *fh = tmpfile();
+  if (fh == NULL)
+    return 0;
+  Merge m;
+  merge_open(&m, runs, n, e->size);
+  uint32_t *record = malloc(e->size), *last = malloc(e->size);
+  int have_last = 0, ok = 1;
+  while (merge_next(&m, record)) {
+    if (have_last && !memcmp(record, last, e->size))
+      continue;
+    ok &= fwrite(record, e->size, 1, fh) == 1;
+    memcpy(last, record, e->size);
+    have_last = 1;
+  }
+  merge_close(&m, runs, n);
+  free(record);
+  free(last);
+
+  runs[0].level++;
+  runs[0].fh = fh;
+  e->num_runs -= n - 1;
+  return ok;
+}
+
+/* Sort the buffer, drop repeats and write it out as a run.  Then, while
+   there are EXPLORE_MERGE_WAYS runs of the newest level, merge them, so
+   that only a few runs of each level are open at once. */
+static int flush_run(Explorer *e) {
+  if (e->num_buffered == 0)
+    return 1;
+  size_t words = e->k + 1;
+  qsort_r(e->buffer, e->num_buffered, e->size, compare, &e->size);
+  size_t n = 1;
+  for (size_t i = 1; i < e->num_buffered; i++) {
+    if (memcmp(e->buffer + (n - 1) * words, e->buffer + i * words, e->size))
+      memcpy(e->buffer + n++ * words, e->buffer + i * words, e->size);
+  }
+  FILE *fh = tmpfile();
+  if (fh == NULL || fwrite(e->buffer, e->size, n, fh) != n) {
+    if (fh)
+      fclose(fh);
+    return 0;
+  }
+  if (e->num_runs == e->runs_size) {
+    e->runs_size = e->runs_size ? 2 * e->runs_size : 16;
+    e->runs = realloc(e->runs, e->runs_size * sizeof(Run));
+  }
+  e->runs[e->num_runs].fh = fh;
+  e->runs[e->num_runs].level = 0;
+  e->num_runs++;
+  e->num_buffered = 0;
+
+  while (e->num_runs >= EXPLORE_MERGE_WAYS &&
+         e->runs[e->num_runs - EXPLORE_MERGE_WAYS].level ==
+         e->runs[e->num_runs - 1].level) {
+    if (!collapse_runs(e, EXPLORE_MERGE_WAYS))
+      return 0;
+  }
+  return 1;
+}
+
+static int buffer_record(Explorer *e, const uint32_t *record) {
+  if (e->num_buffered == e->buffer_records && !flush_run(e))
+    return 0;
+  memcpy(e->buffer + e->num_buffered++ * (e->k + 1), record, e->size);
+  return 1;
+}
+
+/* Buffer every child of the state in record. */
+static int expand(Explorer *e, const uint32_t *record) {
+  const FlatGraph *f = e->flat;
+  uint32_t *child = malloc(e->size);
+  memset(e->agent, AGENT_NONE, f->num_tiles);
+  for (size_t i = 0; i < e->k; i++)
+    e->agent[record[i]] = AGENT_BOX;
+
+  pushes_flood(e->pushes, e->agent, record[e->k]);
+  size_t num_pushes;
+  const Push *list = pushes_list(e->pushes, e->agent, &num_pushes);
+  int ok = 1;
+  for (size_t j = 0; j < num_pushes && ok; j++) {
+    const Push *push = &list[j];
+    e->agent[push->box] = AGENT_NONE;
+    e->agent[push->to] = AGENT_BOX;
+    child[e->k] = pushes_flood(e->pushes, e->agent, push->box);
+    /* Move the box within the sorted list */
+    size_t n = 0;
+    for (size_t i = 0; i < e->k; i++) {
+      if (record[i] != push->box)
+        child[n++] = record[i];
+    }
+    size_t i = n;
+    for (; i > 0 && child[i - 1] > push->to; i--)
+      child[i] = child[i - 1];
+    child[i] = push->to;
+    ok = e->emit(e, child);
+    e->agent[push->to] = AGENT_NONE;
+    e->agent[push->box] = AGENT_BOX;
+  }
+
+  free(child);
+  return ok;
+}
+
+static int solved(const Explorer *e, const uint32_t *record) {
+  for (size_t i = 0; i < e->k; i++) {
+    if (e->flat->tile_type[record[i]] != TILE_TYPE_TARGET)
+      return 0;
+  }
+  return 1;
+}
+
+/* Merge the runs into the next layer, leaving out what seen already has,
+   and write seen with the next layer added to it as well.  The newest runs
+   are merged first until no more than EXPLORE_MERGE_WAYS are left. */
+static int merge_runs(Explorer *e, FILE *seen, FILE *layer, FILE *new_seen,
+    size_t *count, size_t *num_solved) {
+  size_t size = e->size;
+  while (e->num_runs > EXPLORE_MERGE_WAYS) {
+    if (!collapse_runs(e, EXPLORE_MERGE_WAYS))
+      return 0;
+  }
+
+  Merge runs;
+  Stream old;
+  merge_open(&runs, e->runs, e->num_runs, size);
+  stream_open(&old, seen, size);
+  uint32_t *record = malloc(size), *last = malloc(size);
+  int have_last = 0, ok = 1;
+  *count = 0;
+  *num_solved = 0;
+
+  while (merge_next(&runs, record)) {
+    /* Runs are free of repeats, but not of each other's */
+    if (have_last && !memcmp(record, last, size))
+      continue;
+    memcpy(last, record, size);
+    have_last = 1;
+
+    while (old.live && memcmp(old.record, last, size) < 0) {
+      ok &= fwrite(old.record, size, 1, new_seen) == 1;
+      stream_next(&old, size);
+    }
+    if (old.live && !memcmp(old.record, last, size))
+      continue;
+    ok &= fwrite(last, size, 1, layer) == 1;
+    ok &= fwrite(last, size, 1, new_seen) == 1;
+    (*count)++;
+    *num_solved += solved(e, last);
+  }
+  while (old.live) {
+    ok &= fwrite(old.record, size, 1, new_seen) == 1;
+    stream_next(&old, size);
+  }
+
+  merge_close(&runs, e->runs, e->num_runs);
+  e->num_runs = 0;
+  free(old.record);
+  free(record);
+  free(last);
+  return ok;
+}
+
+static void add_layer(ExploreResult *result, size_t count, size_t num_solved) {
+  result->states = realloc(result->states,
+      (result->depth + 1) * sizeof(size_t));
+  result->solved = realloc(result->solved,
+      (result->depth + 1) * sizeof(size_t));
+  result->states[result->depth] = count;
+  result->solved[result->depth] = num_solved;
+  result->depth++;
+  result->total += count;
+}
+
+/* Expand layer after layer, sorting each into files. */
+static int explore_files(Explorer *e, uint32_t *record, size_t memory,
+    size_t max_states, ExploreResult *result) {
+  e->emit = buffer_record;
+  e->buffer_records = memory / e->size ? memory / e->size : 1;
+  e->buffer = malloc(e->buffer_records * e->size);
+
+  FILE *layer = tmpfile(), *seen = tmpfile();
+  int ok = layer && seen && fwrite(record, e->size, 1, layer) == 1 &&
+    fwrite(record, e->size, 1, seen) == 1;
+  if (ok)
+    add_layer(result, 1, solved(e, record));
+
+  while (ok && result->states[result->depth - 1] &&
+         result->total <= max_states) {
+    rewind(layer);
+    while (ok && fread(record, e->size, 1, layer) == 1)
+      ok = expand(e, record);
+    ok = ok && flush_run(e);
+    FILE *next = tmpfile(), *new_seen = tmpfile();
+    size_t count, num_solved;
+    ok = ok && next && new_seen &&
+      merge_runs(e, seen, next, new_seen, &count, &num_solved);
+    fclose(layer);
+    fclose(seen);
+    layer = next;
+    seen = new_seen;
+    if (ok)
+      add_layer(result, count, num_solved);
+  }
+
+  if (layer)
+    fclose(layer);
+  if (seen)
+    fclose(seen);
+  for (size_t i = 0; i < e->num_runs; i++)
+    fclose(e->runs[i].fh);
+  free(e->runs);
+  free(e->buffer);
+  return ok;
+}
+
+static int mark_record(Explorer *e, const uint32_t *record) {
+  uint64_t rank = ranker_rank(e->ranker, record, record[e->k]);
+  if (e->seen[rank / 64] & (1ULL << (rank % 64)))
+    return 1;
+  e->seen[rank / 64] |= 1ULL << (rank % 64);
+  e->count++;
+  e->num_solved += solved(e, record);
+  return fwrite(&rank, sizeof(uint64_t), 1, e->next) == 1;
+}
+
+/* Expand layer after layer, with a bit for every state saying whether it
+   has been seen.  A layer is then a file of ranks, in no order. */
+static int explore_bitmap(Explorer *e, uint32_t *record, size_t max_states,
+    ExploreResult *result) {
+  e->emit = mark_record;
+  e->seen = calloc(ranker_size(e->ranker) / 64 + 1, sizeof(uint64_t));
+
+  FILE *layer = e->next = tmpfile();
+  e->count = e->num_solved = 0;
+  int ok = layer && mark_record(e, record);
+  if (ok)
+    add_layer(result, e->count, e->num_solved);
+
+  while (ok && result->states[result->depth - 1] &&
+         result->total <= max_states) {
+    e->next = tmpfile();
+    e->count = e->num_solved = 0;
+    ok = e->next != NULL;
+    rewind(layer);
+    uint64_t rank;
+    while (ok && fread(&rank, sizeof(uint64_t), 1, layer) == 1) {
+      ranker_unrank(e->ranker, rank, record, &record[e->k]);
+      ok = expand(e, record);
+    }
+    fclose(layer);
+    layer = e->next;
+    if (ok)
+      add_layer(result, e->count, e->num_solved);
+  }
+
+  if (layer)
+    fclose(layer);
+  free(e->seen);
+  return ok;
+}
+
+ExploreResult *explore_board(Board *board, size_t max_states,
+    size_t memory) {
+  const FlatGraph *f = board->flat;
+  ExploreResult *result = calloc(1, sizeof(ExploreResult));
+  double start = get_time();
+
+  Explorer e;
+  memset(&e, 0, sizeof(Explorer));
+  e.flat = f;
+  e.pushes = new_pushes(board);
+  e.agent = malloc(f->num_tiles);
+  for (size_t t = 0; t < f->num_tiles; t++)
+    e.k += f->agent[t] == AGENT_BOX;
+  e.size = (e.k + 1) * sizeof(uint32_t);
+
+  uint32_t *record = malloc(e.size);
+  size_t n = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    if (f->agent[t] == AGENT_BOX)
+      record[n++] = t;
+  }
+  record[e.k] = pushes_flood(e.pushes, f->agent, FLAT_TILE(board->player));
+
+  /* A bit a state beats sorting whenever the bits fit.  A box that
+     starts on a dead tile can't be ranked, but can't be solved either. */
+  Ranker *ranker = new_ranker(board);
+  int ok;
+  if (ranker && ranker_size(ranker) / 8 < memory &&
+      ranker_rank(ranker, record, record[e.k]) != RANK_NONE) {
+    e.ranker = ranker;
+    ok = explore_bitmap(&e, record, max_states, result);
+  } else {
+    ok = explore_files(&e, record, memory, max_states, result);
+  }
+  /* The last layer counted is empty */
+  if (ok && result->states[result->depth - 1] == 0) {
+    result->finished = 1;
+    result->depth--;
+  }
+
+  if (ranker)
+    free_ranker(ranker);
+  free(e.agent);
+  free(record);
+  free_pushes(e.pushes);
+
+  if (!ok) {
+    perror("Could not write states out");
+    free_explore_result(result);
+    return NULL;
+  }
+  result->seconds = get_time() - start;
+  return result;
+}
+
+void free_explore_result(ExploreResult *result) {
+  free(result->states);
+  free(result->solved);
+  free(result);
+}
@@ -0,0 +1,65 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__EXPLORE_H
+#define __HYPERBAN__EXPLORE_H
+
+#include <stddef.h>
+
+#include "../graph/types.h"
+
+/* Count every state reachable from a board, by number of pushes, without
+   holding them all in memory.  Each layer of states is a sorted file of
+   fixed-size records: the boxes' tiles in order, then the least tile of
+   the player's region.  Expanding a layer writes its children out in
+   sorted runs, one per bufferful; the runs are then merged with the file
+   of every state seen so far, which drops the duplicates, and the merge
+   writes out both the next layer and the new file of states seen.  Runs
+   are merged EXPLORE_MERGE_WAYS at a time, picking the least record from
+   a heap, so that however many there are only a few files are open at
+   once.  The files are temporary and go away when the count is done.
+
+   When there is memory for a bit for every state there could be (see
+   rank.h), the bits say which states have been seen instead, and a layer
+   is just a file of ranks.
+
+   Pushes that would leave a box on a dead tile are not made, as in the
+   solver, so those states are not counted. */
+
+typedef struct {
+  int finished; /* every reachable state was counted */
+  size_t depth; /* number of layers */
+  size_t *states; /* states[d] were first reached with d pushes */
+  size_t *solved; /* how many of states[d] have every box on a target */
+  size_t total;
+  double seconds;
+} ExploreResult;
+
+/* Give up once more than max_states have been found.  memory is the size
+   of the bitmap, or else of the buffer for sorting children.  Returns NULL
+   if the files could not be made. */
+ExploreResult *explore_board (Board *board, size_t max_states,
+                              size_t memory);
+
+void free_explore_result (ExploreResult *result);
+
+#define EXPLORE_MERGE_WAYS 64
+
+#endif /* __HYPERBAN__EXPLORE_H */
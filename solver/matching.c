@@ -0,0 +1,312 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "matching.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../graph/audit.h"
+#include "../graph/flat.h"
+
+#define NO_DISTANCE UINT16_MAX
+#define NO_TILE UINT32_MAX
+
+/* Rows and columns count from 1; row and column 0 are the Hungarian
+   method's scratch space. */
+struct matching_t {
+  const FlatGraph *flat;
+  size_t n; /* targets; the boxes are padded out with rows costing 0 */
+  size_t num_boxes;
+  uint16_t *distance; /* pushes from each tile to each target */
+  int shared; /* distance belongs to another matching */
+  int64_t far; /* the cost of a target a box can't reach */
+  int64_t *u; /* prices of rows */
+  int64_t *v; /* prices of columns */
+  size_t *row; /* the row matched to each column */
+  size_t *column; /* the column matched to each row */
+  uint32_t *tile; /* the box of each row, or NO_TILE */
+  size_t *row_of; /* the row of the box on each tile */
+  /* scratch for augment */
+  int64_t *slack;
+  size_t *way;
+  char *used;
+  /* matching_save */
+  int64_t *saved_u;
+  int64_t *saved_v;
+  size_t *saved_row;
+  size_t *saved_column;
+  uint32_t *saved_tile;
+};
+
+/* Pull a lone box back from each target. */
+static void find_distances(Matching *m) {
+  const FlatGraph *f = m->flat;
+  uint32_t *dist = malloc(f->num_tiles * sizeof(uint32_t));
+  uint32_t *queue = malloc(f->num_tiles * sizeof(uint32_t));
+
+  size_t j = 0;
+  for (uint32_t target = 0; target < f->num_tiles; target++) {
+    if (f->tile_type[target] != TILE_TYPE_TARGET)
+      continue;
+    audit_pull_distances_from(f, target, dist, queue);
+    uint16_t *distance = m->distance + j++;
+    for (size_t t = 0; t < f->num_tiles; t++)
+      distance[t * m->n] = dist[t] < NO_DISTANCE ? dist[t] : NO_DISTANCE;
+  }
+
+  free(dist);
+  free(queue);
+}
+
+static void alloc_matching(Matching *m) {
+  const FlatGraph *f = m->flat;
+  size_t n = m->n + 1;
+  m->num_boxes = 0;
+  m->u = malloc(n * sizeof(int64_t));
+  m->v = malloc(n * sizeof(int64_t));
+  m->row = malloc(n * sizeof(size_t));
+  m->column = malloc(n * sizeof(size_t));
+  m->tile = malloc(n * sizeof(uint32_t));
+  m->row_of = malloc(f->num_tiles * sizeof(size_t));
+  m->slack = malloc(n * sizeof(int64_t));
+  m->way = malloc(n * sizeof(size_t));
+  m->used = malloc(n);
+  m->saved_u = malloc(n * sizeof(int64_t));
+  m->saved_v = malloc(n * sizeof(int64_t));
+  m->saved_row = malloc(n * sizeof(size_t));
+  m->saved_column = malloc(n * sizeof(size_t));
+  m->saved_tile = malloc(n * sizeof(uint32_t));
+}
+
+Matching *new_matching(const Board *board) {
+  const FlatGraph *f = board->flat;
+  Matching *m = malloc(sizeof(Matching));
+  m->flat = f;
+  m->n = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    if (f->tile_type[t] == TILE_TYPE_TARGET)
+      m->n++;
+  }
+  m->distance = malloc(f->num_tiles * m->n * sizeof(uint16_t));
+  m->shared = 0;
+  find_distances(m);
+  /* Leave room for a whole matching of unreachable targets */
+  m->far = INT64_MAX / 4 / (m->n + 1);
+  alloc_matching(m);
+  return m;
+}
+
+Matching *matching_share(const Matching *m) {
+  Matching *copy = malloc(sizeof(Matching));
+  copy->flat = m->flat;
+  copy->n = m->n;
+  copy->distance = m->distance;
+  copy->shared = 1;
+  copy->far = m->far;
+  alloc_matching(copy);
+  return copy;
+}
+
+void free_matching(Matching *m) {
+  if (!m->shared)
+    free(m->distance);
+  free(m->u);
+  free(m->v);
+  free(m->row);
+  free(m->column);
+  free(m->tile);
+  free(m->row_of);
+  free(m->slack);
+  free(m->way);
+  free(m->used);
+  free(m->saved_u);
+  free(m->saved_v);
+  free(m->saved_row);
+  free(m->saved_column);
+  free(m->saved_tile);
+  free(m);
+}
+
+static int64_t cost(const Matching *m, size_t i, size_t j) {
+  if (m->tile[i] == NO_TILE)
+    return 0;
+  uint16_t d = m->distance[m->tile[i] * m->n + j - 1];
+  return d == NO_DISTANCE ? m->far : d;
+}
+
+/* Find row i, which is unmatched, a column along the cheapest alternating
+   path, keeping the prices feasible and tight on the matching. */
+static void augment(Matching *m, size_t i) {
+  size_t n = m->n;
+  for (size_t j = 0; j <= n; j++) {
+    m->slack[j] = INT64_MAX;
+    m->used[j] = 0;
+  }
+  m->row[0] = i;
+  size_t j0 = 0;
+  do {
+    m->used[j0] = 1;
+    size_t i0 = m->row[j0], j1 = 0;
+    int64_t delta = INT64_MAX;
+    for (size_t j = 1; j <= n; j++) {
+      if (m->used[j])
+        continue;
+      int64_t c = cost(m, i0, j) - m->u[i0] - m->v[j];
+      if (c < m->slack[j]) {
+        m->slack[j] = c;
+        m->way[j] = j0;
+      }
+      if (m->slack[j] < delta) {
+        delta = m->slack[j];
+        j1 = j;
+      }
+    }
+    for (size_t j = 0; j <= n; j++) {
+      if (m->used[j]) {
+        m->u[m->row[j]] += delta;
+        m->v[j] -= delta;
+      } else {
+        m->slack[j] -= delta;
+      }
+    }
+    j0 = j1;
+  } while (m->row[j0] != 0);
+  do {
+    size_t j1 = m->way[j0];
+    m->row[j0] = m->row[j1];
+    m->column[m->row[j0]] = j0;
+    j0 = j1;
+  } while (j0);
+}
+
+static uint32_t total(const Matching *m) {
+  if (m->num_boxes > m->n)
+    return MATCHING_NONE;
+  int64_t sum = 0;
+  for (size_t i = 1; i <= m->n; i++)
+    sum += cost(m, i, m->column[i]);
+  return sum >= m->far ? MATCHING_NONE : (uint32_t) sum;
+}
+
+uint32_t matching_reset(Matching *m, const char *agent) {
+  const FlatGraph *f = m->flat;
+  m->num_boxes = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    if (agent[t] != AGENT_BOX)
+      continue;
+    if (++m->num_boxes > m->n)
+      return MATCHING_NONE;
+    m->tile[m->num_boxes] = t;
+    m->row_of[t] = m->num_boxes;
+  }
+  for (size_t i = m->num_boxes + 1; i <= m->n; i++)
+    m->tile[i] = NO_TILE;
+
+  for (size_t i = 0; i <= m->n; i++) {
+    m->u[i] = 0;
+    m->v[i] = 0;
+    m->row[i] = 0;
+    m->column[i] = 0;
+  }
+  for (size_t i = 1; i <= m->n; i++)
+    augment(m, i);
+  return total(m);
+}
+
+uint32_t matching_move(Matching *m, uint32_t from, uint32_t to) {
+  if (m->num_boxes > m->n)
+    return MATCHING_NONE;
+  size_t i = m->row_of[from];
+  m->row_of[to] = i;
+  m->tile[i] = to;
+
+  /* Unmatch the row, and price it as high as it can go */
+  m->row[m->column[i]] = 0;
+  m->column[i] = 0;
+  int64_t u = INT64_MAX;
+  for (size_t j = 1; j <= m->n; j++) {
+    int64_t c = cost(m, i, j) - m->v[j];
+    if (c < u)
+      u = c;
+  }
+  m->u[i] = u;
+  augment(m, i);
+  return total(m);
+}
+
+void matching_save(Matching *m) {
+  size_t n = m->n + 1;
+  memcpy(m->saved_u, m->u, n * sizeof(int64_t));
+  memcpy(m->saved_v, m->v, n * sizeof(int64_t));
+  memcpy(m->saved_row, m->row, n * sizeof(size_t));
+  memcpy(m->saved_column, m->column, n * sizeof(size_t));
+  memcpy(m->saved_tile, m->tile, n * sizeof(uint32_t));
+}
+
+void matching_restore(Matching *m) {
+  size_t n = m->n + 1;
+  for (size_t i = 1; i < n; i++) {
+    if (m->saved_tile[i] != m->tile[i])
+      m->row_of[m->saved_tile[i]] = i;
+  }
+  memcpy(m->u, m->saved_u, n * sizeof(int64_t));
+  memcpy(m->v, m->saved_v, n * sizeof(int64_t));
+  memcpy(m->row, m->saved_row, n * sizeof(size_t));
+  memcpy(m->column, m->saved_column, n * sizeof(size_t));
+  memcpy(m->tile, m->saved_tile, n * sizeof(uint32_t));
+}
+
+size_t matching_packed_size(const Matching *m) {
+  size_t size = m->n * (sizeof(int64_t) + sizeof(uint32_t));
+  return (size + 7) & ~(size_t) 7;
+}
+
+/* Every column is matched, since the boxes are padded out to n rows. */
+void matching_pack(const Matching *m, void *packed) {
+  int64_t *v = packed;
+  uint32_t *tile = (uint32_t *) (v + m->n);
+  for (size_t j = 1; j <= m->n; j++) {
+    v[j - 1] = m->v[j];
+    tile[j - 1] = m->tile[m->row[j]];
+  }
+}
+
+/* Row j is matched to column j. */
+void matching_unpack(Matching *m, const void *packed) {
+  const int64_t *v = packed;
+  const uint32_t *tile = (const uint32_t *) (v + m->n);
+  m->num_boxes = 0;
+  m->u[0] = 0;
+  m->v[0] = 0;
+  m->row[0] = 0;
+  m->column[0] = 0;
+  for (size_t j = 1; j <= m->n; j++) {
+    m->v[j] = v[j - 1];
+    m->tile[j] = tile[j - 1];
+    m->row[j] = j;
+    m->column[j] = j;
+    if (m->tile[j] != NO_TILE) {
+      m->row_of[m->tile[j]] = j;
+      m->num_boxes++;
+    }
+    m->u[j] = cost(m, j, j) - m->v[j];
+  }
+}
@@ -0,0 +1,67 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__MATCHING_H
+#define __HYPERBAN__MATCHING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* A lower bound on the pushes left: the cheapest way to send every box to
+   a target of its own, where sending a box costs the pushes it would take
+   with no other box in the way.  This is an assignment problem, solved by
+   the Hungarian method.  Its dual prices are kept, so that when one box
+   moves only that box has to be matched again. */
+
+typedef struct matching_t Matching;
+
+Matching *new_matching (const Board *board);
+void free_matching (Matching *m);
+
+/* Another matching for the same board, for another thread.  It shares
+   the distances, which are never written, with m, so m must outlive it. */
+Matching *matching_share (const Matching *m);
+
+/* Match the boxes in agent from scratch, and return the cost. */
+uint32_t matching_reset (Matching *m, const char *agent);
+
+/* The box on tile from has moved to tile to; return the new cost. */
+uint32_t matching_move (Matching *m, uint32_t from, uint32_t to);
+
+/* Remember the current matching, and go back to it. */
+void matching_save (Matching *m);
+void matching_restore (Matching *m);
+
+/* A matching packed into matching_packed_size bytes, a multiple of 8, so
+   that a search can keep one with each state and pick up where the
+   parent's left off instead of solving again.  It holds the price of each
+   target and the box matched to it; the boxes' prices follow, since each
+   is tight on its match. */
+size_t matching_packed_size (const Matching *m);
+void matching_pack (const Matching *m, void *packed);
+void matching_unpack (Matching *m, const void *packed);
+
+/* Returned when some box can't be given a target it can reach, so the
+   position can't be solved. */
+#define MATCHING_NONE UINT32_MAX
+
+#endif /* __HYPERBAN__MATCHING_H */
@@ -0,0 +1,171 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "pushes.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../graph/audit.h"
+#include "../graph/flat.h"
+#include "reach.h"
+
+struct pushes_t {
+  const Board *board;
+  const FlatGraph *flat;
+  Reach *reach;
+  uint32_t start;
+  /* Only pushes_path walks tile by tile, inside the region. */
+  uint32_t *queue;
+  uint32_t *stamp; /* seen by the last pushes_path if equal to epoch */
+  uint32_t epoch;
+  uint32_t *parent; /* 4 * tile + edge the tile was first reached across */
+  Push *list;
+};
+
+Pushes *new_pushes(const Board *board) {
+  size_t n = board->flat->num_tiles;
+  Pushes *p = malloc(sizeof(Pushes));
+  p->board = board;
+  p->flat = board->flat;
+  p->reach = new_reach(board->flat);
+  p->start = 0;
+  p->queue = malloc(n * sizeof(uint32_t));
+  p->stamp = calloc(n, sizeof(uint32_t));
+  p->epoch = 0;
+  p->parent = malloc(n * sizeof(uint32_t));
+  p->list = malloc(4 * n * sizeof(Push));
+  return p;
+}
+
+void free_pushes(Pushes *p) {
+  free_reach(p->reach);
+  free(p->queue);
+  free(p->stamp);
+  free(p->parent);
+  free(p->list);
+  free(p);
+}
+
+static int open_tile(const FlatGraph *f, const char *agent, uint32_t entry) {
+  return entry != FLAT_NONE &&
+    f->tile_type[FLAT_TILE(entry)] != TILE_TYPE_WALL &&
+    agent[FLAT_TILE(entry)] != AGENT_BOX;
+}
+
+uint32_t pushes_flood(Pushes *p, const char *agent, uint32_t start) {
+  p->start = start;
+  return reach_flood(p->reach, agent, start);
+}
+
+int pushes_reachable(const Pushes *p, uint32_t t) {
+  return REACH_HAS(reach_bits(p->reach), t);
+}
+
+const uint32_t *pushes_region(const Pushes *p, size_t *n) {
+  return reach_region(p->reach, n);
+}
+
+const Push *pushes_list(Pushes *p, const char *agent, size_t *n) {
+  const FlatGraph *f = p->flat;
+  size_t num = 0, size;
+  const uint32_t *region = reach_region(p->reach, &size);
+  for (size_t i = 0; i < size; i++) {
+    uint32_t t = region[i];
+    for (int d = 0; d < 4; d++) {
+      uint32_t b = f->neighbor[4 * t + d];
+      if (b == FLAT_NONE || agent[FLAT_TILE(b)] != AGENT_BOX)
+        continue;
+      /* b faces back at t, so the box goes out the opposite edge */
+      uint32_t q = f->neighbor[(b & ~3u) | ((b + 2) & 3)];
+      if (!open_tile(f, agent, q) || audit_is_dead(p->board, FLAT_TILE(q)))
+        continue;
+      Push *push = &p->list[num++];
+      push->tile = t;
+      push->box = FLAT_TILE(b);
+      push->to = FLAT_TILE(q);
+      push->edge = d;
+    }
+  }
+  *n = num;
+  return p->list;
+}
+
+const Push *pushes_list_pulls(Pushes *p, const char *agent, size_t *n) {
+  const FlatGraph *f = p->flat;
+  size_t num = 0, size;
+  const uint32_t *region = reach_region(p->reach, &size);
+  for (size_t i = 0; i < size; i++) {
+    uint32_t t = region[i];
+    for (int d = 0; d < 4; d++) {
+      uint32_t b = f->neighbor[4 * t + d];
+      if (b == FLAT_NONE || agent[FLAT_TILE(b)] != AGENT_BOX)
+        continue;
+      /* The player backs away from the box, out the opposite edge; q faces
+         back at t, so its orientation is the edge it would push across */
+      uint32_t q = f->neighbor[4 * t + ((d + 2) & 3)];
+      if (!open_tile(f, agent, q))
+        continue;
+      Push *push = &p->list[num++];
+      push->tile = FLAT_TILE(q);
+      push->box = t;
+      push->to = FLAT_TILE(b);
+      push->edge = FLAT_ORIENTATION(q);
+    }
+  }
+  *n = num;
+  return p->list;
+}
+
+size_t pushes_path(Pushes *p, uint32_t t, int *edges) {
+  const FlatGraph *f = p->flat;
+  const uint64_t *bits = reach_bits(p->reach);
+  if (++p->epoch == 0) {
+    memset(p->stamp, 0, f->num_tiles * sizeof(uint32_t));
+    p->epoch = 1;
+  }
+
+  /* A breadth-first walk inside the region, as far as t */
+  size_t head = 0, tail = 0;
+  p->stamp[p->start] = p->epoch;
+  p->queue[tail++] = p->start;
+  while (head < tail && p->stamp[t] != p->epoch) {
+    uint32_t u = p->queue[head++];
+    for (int d = 0; d < 4; d++) {
+      uint32_t n = f->neighbor[4 * u + d];
+      if (n == FLAT_NONE)
+        continue;
+      n = FLAT_TILE(n);
+      if (!REACH_HAS(bits, n) || p->stamp[n] == p->epoch)
+        continue;
+      p->stamp[n] = p->epoch;
+      p->parent[n] = 4 * u + d;
+      p->queue[tail++] = n;
+    }
+  }
+
+  size_t n = 0;
+  for (uint32_t u = t; u != p->start; u = p->parent[u] / 4)
+    n++;
+  size_t i = n;
+  for (uint32_t u = t; u != p->start; u = p->parent[u] / 4)
+    edges[--i] = p->parent[u] % 4;
+  return n;
+}
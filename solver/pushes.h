@@ -0,0 +1,71 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__PUSHES_H
+#define __HYPERBAN__PUSHES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* Successors at the level of pushes: all the walking between two pushes is
+   one flood of the player's region, and the region stands in for wherever
+   the player is in it by its least tile. */
+
+typedef struct {
+  uint32_t tile; /* the player pushes from here */
+  uint32_t box; /* the box's tile, across edge from tile */
+  uint32_t to; /* where the box ends up */
+  int edge;
+} Push;
+
+typedef struct pushes_t Pushes;
+
+Pushes *new_pushes (const Board *board);
+void free_pushes (Pushes *p);
+
+/* Mark the tiles the player can walk to from tile start, given the boxes
+   in agent.  Returns the least of them. */
+uint32_t pushes_flood (Pushes *p, const char *agent, uint32_t start);
+
+/* After pushes_flood, whether the player can walk to tile t. */
+int pushes_reachable (const Pushes *p, uint32_t t);
+
+/* After pushes_flood, the tiles it reached, a step of the flood at a
+   time. */
+const uint32_t *pushes_region (const Pushes *p, size_t *n);
+
+/* After pushes_flood, the pushes the player can make without leaving a box
+   on a dead tile.  The list lasts until the next call, whatever floods
+   happen in between. */
+const Push *pushes_list (Pushes *p, const char *agent, size_t *n);
+
+/* Likewise for pulls, walking backwards from a position.  Each is given as
+   the push it undoes: the box goes back from to to box, and the player
+   from box to tile.  Dead tiles are not avoided. */
+const Push *pushes_list_pulls (Pushes *p, const char *agent, size_t *n);
+
+/* After pushes_flood, the edges crossed on a shortest walk from its start
+   to tile t, which must be reachable.  edges must have room for every tile
+   of the board; returns how many there are. */
+size_t pushes_path (Pushes *p, uint32_t t, int *edges);
+
+#endif /* __HYPERBAN__PUSHES_H */
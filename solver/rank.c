@@ -0,0 +1,123 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "rank.h"
+
+#include <stdlib.h>
+
+#include "../graph/audit.h"
+
+#define NOT_COUNTED UINT32_MAX
+
+struct ranker_t {
+  size_t k; /* boxes */
+  size_t n; /* tiles a box can be on */
+  size_t num_players; /* tiles the player can be on */
+  uint32_t *box_index; /* of each tile, or NOT_COUNTED */
+  uint32_t *box_tile; /* of each index */
+  uint32_t *player_index;
+  uint32_t *player_tile;
+  uint64_t *choose; /* C(i, j) at i * (k + 1) + j, or UINT64_MAX if too big */
+  uint64_t box_sets;
+};
+
+#define CHOOSE(r, i, j) ((r)->choose[(i) * ((r)->k + 1) + (j)])
+
+Ranker *new_ranker(const Board *board) {
+  const FlatGraph *f = board->flat;
+  Ranker *r = calloc(1, sizeof(Ranker));
+  r->box_index = malloc(f->num_tiles * sizeof(uint32_t));
+  r->box_tile = malloc(f->num_tiles * sizeof(uint32_t));
+  r->player_index = malloc(f->num_tiles * sizeof(uint32_t));
+  r->player_tile = malloc(f->num_tiles * sizeof(uint32_t));
+  for (uint32_t t = 0; t < f->num_tiles; t++) {
+    r->k += f->agent[t] == AGENT_BOX;
+    r->box_index[t] = r->player_index[t] = NOT_COUNTED;
+    if (f->tile_type[t] == TILE_TYPE_WALL)
+      continue;
+    r->player_tile[r->num_players] = t;
+    r->player_index[t] = r->num_players++;
+    if (audit_is_dead(board, t))
+      continue;
+    r->box_tile[r->n] = t;
+    r->box_index[t] = r->n++;
+  }
+
+  /* Pascal's triangle, as far as it is needed */
+  r->choose = malloc((r->n + 1) * (r->k + 1) * sizeof(uint64_t));
+  for (size_t i = 0; i <= r->n; i++) {
+    CHOOSE(r, i, 0) = 1;
+    for (size_t j = 1; j <= r->k; j++) {
+      uint64_t a = i ? CHOOSE(r, i - 1, j - 1) : 0;
+      uint64_t b = i ? CHOOSE(r, i - 1, j) : 0;
+      CHOOSE(r, i, j) = (a == UINT64_MAX || b == UINT64_MAX ||
+          a + b < a) ? UINT64_MAX : a + b;
+    }
+  }
+  r->box_sets = CHOOSE(r, r->n, r->k);
+  if (r->box_sets == UINT64_MAX || r->num_players == 0 ||
+      r->box_sets > (UINT64_MAX - 1) / r->num_players) {
+    free_ranker(r);
+    return NULL;
+  }
+  return r;
+}
+
+void free_ranker(Ranker *r) {
+  free(r->box_index);
+  free(r->box_tile);
+  free(r->player_index);
+  free(r->player_tile);
+  free(r->choose);
+  free(r);
+}
+
+uint64_t ranker_size(const Ranker *r) {
+  return r->box_sets * r->num_players;
+}
+
+uint64_t ranker_rank(const Ranker *r, const uint32_t *boxes,
+    uint32_t player) {
+  uint64_t rank = 0;
+  for (size_t i = 0; i < r->k; i++) {
+    uint32_t c = r->box_index[boxes[i]];
+    if (c == NOT_COUNTED)
+      return RANK_NONE;
+    rank += CHOOSE(r, c, i + 1);
+  }
+  if (r->player_index[player] == NOT_COUNTED)
+    return RANK_NONE;
+  return rank * r->num_players + r->player_index[player];
+}
+
+void ranker_unrank(const Ranker *r, uint64_t rank, uint32_t *boxes,
+    uint32_t *player) {
+  *player = r->player_tile[rank % r->num_players];
+  rank /= r->num_players;
+  /* Greedily, from the top: each digit is the largest that fits */
+  size_t c = r->n;
+  for (size_t i = r->k; i > 0; i--) {
+    do
+      c--;
+    while (CHOOSE(r, c, i) > rank);
+    rank -= CHOOSE(r, c, i);
+    boxes[i - 1] = r->box_tile[c];
+  }
+}
@@ -0,0 +1,55 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__RANK_H
+#define __HYPERBAN__RANK_H
+
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* Numbers the states of a board densely from 0, so that a set of states
+   can be a bitmap.  The k boxes are a k-subset of the n tiles a box can
+   stand on without being dead, ranked in the combinatorial number system:
+   boxes on the tiles numbered c1 < c2 < ... < ck get
+   C(c1, 1) + C(c2, 2) + ... + C(ck, k).  Tiles are numbered in flat order,
+   which is fixed by the level.  The player's tile, which can be any tile
+   that isn't a wall, is the last digit. */
+
+typedef struct ranker_t Ranker;
+
+/* Returns NULL if the states don't fit in 64 bits. */
+Ranker *new_ranker (const Board *board);
+void free_ranker (Ranker *r);
+
+/* The number of states. */
+uint64_t ranker_size (const Ranker *r);
+
+/* boxes is the k box tiles in increasing order.  Returns RANK_NONE if a
+   box is on a dead tile, or the player on a wall. */
+uint64_t ranker_rank (const Ranker *r, const uint32_t *boxes,
+                      uint32_t player);
+
+void ranker_unrank (const Ranker *r, uint64_t rank, uint32_t *boxes,
+                    uint32_t *player);
+
+#define RANK_NONE UINT64_MAX
+
+#endif /* __HYPERBAN__RANK_H */
@@ -0,0 +1,45 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "rating.h"
+
+#include <math.h>
+
+void rate_board(Board *board, const SolverParams *params, Rating *rating) {
+  SolverResult *result = solve_board(board, params);
+
+  rating->status = result->status;
+  rating->pushes = result->pushes;
+  rating->nodes_expanded = result->nodes_expanded;
+  rating->branching = result->nodes_expanded
+    ? (double) result->nodes_generated / result->nodes_expanded : 0;
+  rating->difficulty = 0;
+
+  if (result->status == SOLVER_SOLVED) {
+    /* The search expands at least the states along the solution. */
+    size_t detour = result->nodes_expanded > result->pushes
+      ? result->nodes_expanded - result->pushes : 0;
+    double score = result->pushes * log2(1 + rating->branching)
+      + log2(1 + detour);
+    rating->difficulty = (int) ceil(score);
+  }
+
+  free_solver_result(result);
+}
@@ -0,0 +1,53 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__RATING_H
+#define __HYPERBAN__RATING_H
+
+#include <stddef.h>
+
+#include "../graph/types.h"
+#include "solver.h"
+
+/* How hard a level is, going by what the solver had to do to solve it.
+   Each push of a push-optimal solution counts for the log2 of one more
+   than the pushes on offer in an average state, so a push with nothing
+   else to do counts 1, and every doubling of the states the search looked
+   at beyond the solution's own adds 1 more.  Levels with more boxes, more
+   room to move them and more ways to go wrong come out higher. */
+
+typedef struct {
+  solver_status_t status;
+  size_t pushes; /* of a push-optimal solution, if solved */
+  size_t nodes_expanded;
+  double branching; /* pushes generated per state expanded */
+  int difficulty; /* 0 unless solved */
+} Rating;
+
+/* Rate board with a search bounded by params->max_nodes, so that rating
+   takes about the same time on every level and gives the same answer
+   every time.  A level the search gives up on is left unrated.  The board
+   is not modified. */
+void rate_board (Board *board, const SolverParams *params, Rating *rating);
+
+#define RATING_DEFAULT_MAX_NODES 100000
+#define RATING_DEFAULT_TABLE_SIZE (8 << 20)
+
+#endif /* __HYPERBAN__RATING_H */
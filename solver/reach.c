@@ -0,0 +1,142 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "reach.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "../graph/flat.h"
+
+struct reach_t {
+  const FlatGraph *flat;
+  size_t words; /* in each mask, with room for one more tile than there is */
+  uint32_t *next_tile; /* 4 per tile: the tile across each edge */
+  uint64_t *floor; /* not walls; the extra tile stands for FLAT_NONE */
+  uint64_t *open; /* not walls or boxes */
+  uint64_t *bits; /* reached */
+  uint64_t *scratch; /* neighbours of the frontier */
+  uint32_t *region;
+  size_t region_size;
+};
+
+Reach *new_reach(const FlatGraph *f) {
+  size_t n = f->num_tiles;
+  Reach *r = malloc(sizeof(Reach));
+  r->flat = f;
+  r->words = (n + 1 + 63) / 64;
+  r->next_tile = malloc(4 * n * sizeof(uint32_t));
+  r->floor = calloc(r->words, sizeof(uint64_t));
+  r->open = calloc(r->words, sizeof(uint64_t));
+  r->bits = calloc(r->words, sizeof(uint64_t));
+  r->scratch = calloc(r->words, sizeof(uint64_t));
+  r->region = malloc(n * sizeof(uint32_t));
+  r->region_size = 0;
+  for (size_t t = 0; t < n; t++) {
+    if (f->tile_type[t] != TILE_TYPE_WALL)
+      r->floor[t / 64] |= 1ULL << (t % 64);
+    for (int d = 0; d < 4; d++) {
+      uint32_t e = f->neighbor[4 * t + d];
+      r->next_tile[4 * t + d] = e == FLAT_NONE ? n : FLAT_TILE(e);
+    }
+  }
+  return r;
+}
+
+void free_reach(Reach *r) {
+  free(r->next_tile);
+  free(r->floor);
+  free(r->open);
+  free(r->bits);
+  free(r->scratch);
+  free(r->region);
+  free(r);
+}
+
+static void build_open(Reach *r, const char *agent) {
+  size_t n = r->flat->num_tiles, t = 0;
+#ifdef __AVX2__
+  const __m256i box = _mm256_set1_epi8(AGENT_BOX);
+  for (; t + 64 <= n; t += 64) {
+    __m256i lo = _mm256_loadu_si256((const __m256i *) (agent + t));
+    __m256i hi = _mm256_loadu_si256((const __m256i *) (agent + t + 32));
+    uint64_t boxes =
+      (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, box)) |
+      (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, box))
+      << 32;
+    r->open[t / 64] = r->floor[t / 64] & ~boxes;
+  }
+#endif
+  for (; t < n; t += 64) {
+    uint64_t boxes = 0;
+    for (size_t i = t; i < n && i < t + 64; i++)
+      boxes |= (uint64_t) (agent[i] == AGENT_BOX) << (i - t);
+    r->open[t / 64] = r->floor[t / 64] & ~boxes;
+  }
+}
+
+uint32_t reach_flood(Reach *r, const char *agent, uint32_t start) {
+  for (size_t i = 0; i < r->region_size; i++)
+    r->bits[r->region[i] / 64] = 0;
+  build_open(r, agent);
+
+  uint32_t least = start;
+  size_t head = 0, size = 0;
+  r->bits[start / 64] |= 1ULL << (start % 64);
+  r->region[size++] = start;
+  while (head < size) {
+    /* The words of scratch in use lie between lo and hi */
+    size_t end = size, lo = r->words, hi = 0;
+    for (; head < end; head++) {
+      const uint32_t *next = r->next_tile + 4 * r->region[head];
+      for (int d = 0; d < 4; d++) {
+        size_t w = next[d] / 64;
+        r->scratch[w] |= 1ULL << (next[d] % 64);
+        lo = w < lo ? w : lo;
+        hi = w > hi ? w : hi;
+      }
+    }
+    for (size_t w = lo; w <= hi; w++) {
+      uint64_t fresh = r->scratch[w] & r->open[w] & ~r->bits[w];
+      r->scratch[w] = 0;
+      r->bits[w] |= fresh;
+      for (; fresh; fresh &= fresh - 1) {
+        uint32_t t = 64 * w + __builtin_ctzll(fresh);
+        r->region[size++] = t;
+        if (t < least)
+          least = t;
+      }
+    }
+  }
+  r->region_size = size;
+  return least;
+}
+
+const uint64_t *reach_bits(const Reach *r) {
+  return r->bits;
+}
+
+const uint32_t *reach_region(const Reach *r, size_t *n) {
+  *n = r->region_size;
+  return r->region;
+}
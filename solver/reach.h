@@ -0,0 +1,53 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__REACH_H
+#define __HYPERBAN__REACH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* Where the player can walk, worked out over bitsets of flat tiles.  The
+   tiles that are open to the player are a mask, made from the boxes 64
+   tiles at a time (32 bytes of agent per AVX2 compare, where there is
+   AVX2).  Each step of the flood scatters the frontier's neighbours into
+   scratch words, then takes the new tiles a word at a time as
+   neighbours & open & ~reached, over the span of words the step
+   touched. */
+
+typedef struct reach_t Reach;
+
+Reach *new_reach (const FlatGraph *f);
+void free_reach (Reach *r);
+
+/* Flood from tile start over the tiles that are neither walls nor boxes in
+   agent.  Returns the least tile reached. */
+uint32_t reach_flood (Reach *r, const char *agent, uint32_t start);
+
+/* After reach_flood, a bit for each tile: set if it was reached. */
+const uint64_t *reach_bits (const Reach *r);
+#define REACH_HAS(bits, t) (((bits)[(t) / 64] >> ((t) % 64)) & 1)
+
+/* After reach_flood, the tiles reached, a step of the flood at a time. */
+const uint32_t *reach_region (const Reach *r, size_t *n);
+
+#endif /* __HYPERBAN__REACH_H */
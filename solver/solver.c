@@ -0,0 +1,894 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "solver.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../graph/flat.h"
+#include "../graph/sokoban.h"
+#include "../graph/zobrist.h"
+#include "deadlock.h"
+#include "matching.h"
+#include "pushes.h"
+#include "symmetry.h"
+#include "table.h"
+#include "workers.h"
+
+#define NO_STATE ((size_t) -1)
+
+static const SolverParams default_params = {
+  SOLVER_DEFAULT_MAX_NODES,
+  SOLVER_DEFAULT_TABLE_SIZE,
+  SOLVER_ASTAR,
+  SOLVER_DEFAULT_THREADS
+};
+
+/* A state is stored as this header followed by a bitmap of boxes over the
+   board's flat tiles, and for A* its packed matching.  The player is only
+   known up to the region it can walk around, which is named by its least
+   tile. */
+typedef struct {
+  uint64_t hash; /* of the boxes and the player's region; see state_hash */
+  size_t parent;
+  uint32_t pushes;
+  uint32_t player;
+  uint32_t push_tile; /* the push that led here, from this tile... */
+  int push_edge; /* ...across this edge */
+  int unsolved;
+} StateHeader;
+
+/* A push worth following from a state being expanded, not yet stored. */
+typedef struct {
+  Push push;
+  size_t parent;
+  uint64_t hash;
+  uint32_t player;
+  uint32_t pushes;
+  uint32_t estimate;
+  int unsolved;
+  int keep; /* new to the table */
+} Child;
+
+typedef struct {
+  const Board *board;
+  const FlatGraph *flat;
+  size_t stride;
+  size_t words; /* of bitmap */
+  unsigned char *states;
+  size_t num_states;
+  size_t states_size;
+  TransTable *visited; /* state hash -> pushes it was first reached with */
+  Deadlock *deadlock;
+  Pushes *pushes;
+  Matching *matching;
+  size_t matching_size; /* bytes of packed matching after the bitmap */
+  Symmetry *symmetry; /* NULL unless states are keyed up to symmetry */
+  /* the state being expanded */
+  char *agent;
+  int unsolved;
+  uint64_t hash; /* of the boxes alone */
+  uint64_t *keys; /* of the boxes under each symmetry */
+  Child *children; /* see expand */
+  unsigned char *child_matchings; /* packed, one for each child */
+  size_t num_children;
+  size_t children_size;
+} Search;
+
+#define STATE(s, id) ((StateHeader *) ((s)->states + (id) * (s)->stride))
+#define BOXES(s, id) \
+  ((uint64_t *) ((s)->states + (id) * (s)->stride + sizeof(StateHeader)))
+#define PACKED(s, id) (BOXES(s, id) + (s)->words)
+
+static double get_time(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static size_t new_state(Search *s) {
+  if (s->num_states == s->states_size) {
+    s->states_size *= 2;
+    s->states = realloc(s->states, s->states_size * s->stride);
+  }
+  return s->num_states++;
+}
+
+static void snapshot(Search *s, size_t id) {
+  uint64_t *boxes = BOXES(s, id);
+  memset(boxes, 0, s->words * sizeof(uint64_t));
+  for (size_t i = 0; i < s->flat->num_tiles; i++) {
+    if (s->agent[i] == AGENT_BOX)
+      boxes[i / 64] |= 1ULL << (i % 64);
+  }
+}
+
+static void restore(Search *s, size_t id) {
+  StateHeader *h = STATE(s, id);
+  uint64_t *boxes = BOXES(s, id);
+  memset(s->agent, AGENT_NONE, s->flat->num_tiles);
+  s->hash = 0;
+  for (size_t w = 0; w < s->words; w++) {
+    for (uint64_t bits = boxes[w]; bits; bits &= bits - 1) {
+      size_t t = 64 * w + __builtin_ctzll(bits);
+      s->agent[t] = AGENT_BOX;
+      s->hash ^= ZOBRIST_BOX(t);
+    }
+  }
+  s->unsolved = h->unsolved;
+  if (s->symmetry)
+    symmetry_boxes(s->symmetry, s->agent, s->keys);
+}
+
+/* Move a box as push says, or back again. */
+static void make_push(Search *s, const Push *push, int undo) {
+  const FlatGraph *f = s->flat;
+  uint32_t from = undo ? push->to : push->box;
+  uint32_t to = undo ? push->box : push->to;
+  s->agent[from] = AGENT_NONE;
+  s->agent[to] = AGENT_BOX;
+  s->unsolved += (f->tile_type[from] == TILE_TYPE_TARGET) -
+    (f->tile_type[to] == TILE_TYPE_TARGET);
+  s->hash ^= ZOBRIST_BOX(from) ^ ZOBRIST_BOX(to);
+  if (s->symmetry)
+    symmetry_move(s->symmetry, s->keys, from, to);
+}
+
+/* The hash of the current boxes with the player in the region just
+   flooded, whose least tile is player.  With symmetries, every image of
+   the state gets the same one. */
+static uint64_t state_hash(Search *s, uint32_t player) {
+  if (s->symmetry == NULL)
+    return s->hash ^ ZOBRIST_PLAYER(player);
+  size_t n;
+  const uint32_t *region = pushes_region(s->pushes, &n);
+  return symmetry_hash(s->symmetry, s->keys, region, n);
+}
+
+/* Record the current state, which is push on from state parent, without
+   rescanning it: only one box has moved. */
+static size_t record_child(Search *s, size_t parent, const Push *push,
+    uint32_t player, uint64_t hash, int unsolved) {
+  size_t id = new_state(s);
+  memcpy(STATE(s, id), STATE(s, parent), s->stride);
+  StateHeader *h = STATE(s, id);
+  uint64_t *boxes = BOXES(s, id);
+  h->hash = hash;
+  h->parent = parent;
+  h->pushes++;
+  h->player = player;
+  h->push_tile = push->tile;
+  h->push_edge = push->edge;
+  h->unsolved = unsolved;
+  boxes[push->box / 64] &= ~(1ULL << (push->box % 64));
+  boxes[push->to / 64] |= 1ULL << (push->to % 64);
+  return id;
+}
+
+/* Returns 1 if a state with this hash has already been reached with at most
+   this many pushes.  Only the hash is compared, so a 64-bit collision would
+   wrongly prune a state. */
+static int seen(Search *s, uint64_t hash, uint32_t pushes) {
+  uint32_t best;
+  return ttable_probe(s->visited, hash, &best) && best <= pushes;
+}
+
+static void mark_visited(Search *s, uint64_t hash, uint32_t pushes) {
+  /* Newer layers are worth more, so they win buckets */
+  ttable_store(s->visited, hash, pushes, pushes);
+}
+
+static void append_char(char **str, size_t *length, size_t *size, char c) {
+  if (*length + 1 >= *size) {
+    *size *= 2;
+    *str = realloc(*str, *size);
+  }
+  (*str)[(*length)++] = c;
+  (*str)[*length] = '\0';
+}
+
+/* Play the pushes leading to state id over again from the board's
+   position, filling in the walks between them.  If back is a state of a
+   backward search, carry on with the pushes from it to its goal, which
+   must be where id is. */
+static char *extract_solution(Search *s, size_t id, size_t back,
+    size_t *length) {
+  const FlatGraph *f = s->flat;
+  size_t forward = 0, num_pushes;
+  for (size_t i = id; STATE(s, i)->parent != NO_STATE; i = STATE(s, i)->parent)
+    forward++;
+  num_pushes = forward;
+  for (size_t i = back; i != NO_STATE && STATE(s, i)->parent != NO_STATE;
+       i = STATE(s, i)->parent) {
+    num_pushes++;
+  }
+  size_t *chain = malloc((num_pushes + 1) * sizeof(size_t));
+  size_t n = forward;
+  for (size_t i = id; STATE(s, i)->parent != NO_STATE;
+       i = STATE(s, i)->parent) {
+    chain[--n] = i;
+  }
+  /* A backward state holds the push that leads on from it */
+  n = forward;
+  for (size_t i = back; i != NO_STATE && STATE(s, i)->parent != NO_STATE;
+       i = STATE(s, i)->parent) {
+    chain[n++] = i;
+  }
+
+  char *agent = malloc(f->num_tiles);
+  memcpy(agent, f->agent, f->num_tiles);
+  int *edges = malloc(f->num_tiles * sizeof(int));
+  uint32_t player = s->board->player;
+  int unsolved = s->board->unsolved;
+  uint64_t hash = 0;
+
+  size_t size = 64;
+  char *solution = malloc(size);
+  solution[0] = '\0';
+  *length = 0;
+  for (size_t i = 0; i < num_pushes; i++) {
+    StateHeader *h = STATE(s, chain[i]);
+    pushes_flood(s->pushes, agent, FLAT_TILE(player));
+    size_t walk = pushes_path(s->pushes, h->push_tile, edges);
+    edges[walk++] = h->push_edge;
+    for (size_t j = 0; j < walk; j++) {
+      Move m = (edges[j] - FLAT_ORIENTATION(player)) & 3;
+      move_result_t r = perform_flat_move(f, agent, &player, &unsolved, &hash,
+          m);
+      append_char(&solution, length, &size,
+          sokoban_get_move_abbreviation(m, r == RESULT_PUSH));
+    }
+  }
+
+  free(chain);
+  free(agent);
+  free(edges);
+  return solution;
+}
+
+static void append_id(size_t **ids, size_t *num, size_t *size, size_t id) {
+  if (*num == *size) {
+    *size = *size ? 2 * *size : 64;
+    *ids = realloc(*ids, *size * sizeof(size_t));
+  }
+  (*ids)[(*num)++] = id;
+}
+
+/* Breadth-first search by number of pushes.  A state is a layout of boxes
+   and the region the player can walk around, so walking never makes a
+   state of its own; the first time a state is generated is with as few
+   pushes as it can be reached with. */
+static size_t search_bfs(Search *s, const SolverParams *params,
+    SolverResult *result) {
+  size_t layer_size = 64, next_size = 64;
+  size_t num_layer = 0, num_next = 0;
+  size_t *layer = malloc(layer_size * sizeof(size_t));
+  size_t *next = malloc(next_size * sizeof(size_t));
+  size_t goal = NO_STATE;
+
+  uint32_t pushes = 0;
+
+  append_id(&layer, &num_layer, &layer_size, 0);
+  mark_visited(s, STATE(s, 0)->hash, pushes);
+  if (STATE(s, 0)->unsolved == 0)
+    goal = 0;
+
+  result->status = SOLVER_UNSOLVABLE;
+  while (num_layer && goal == NO_STATE) {
+    for (size_t i = 0; i < num_layer && goal == NO_STATE; i++) {
+      if (result->nodes_expanded >= params->max_nodes) {
+        result->status = SOLVER_LIMIT;
+        goto DONE;
+      }
+      size_t id = layer[i];
+      restore(s, id);
+      result->nodes_expanded++;
+      pushes_flood(s->pushes, s->agent, STATE(s, id)->player);
+      size_t num_pushes;
+      const Push *list = pushes_list(s->pushes, s->agent, &num_pushes);
+      for (size_t j = 0; j < num_pushes && goal == NO_STATE; j++) {
+        const Push *push = &list[j];
+        result->nodes_generated++;
+        make_push(s, push, 0);
+        /* After the push the player stands where the box was */
+        uint32_t player = pushes_flood(s->pushes, s->agent, push->box);
+        uint64_t hash = state_hash(s, player);
+        /* The deadlock tests cost far more than a probe, so come last */
+        if (!seen(s, hash, pushes + 1) && !(s->unsolved &&
+              deadlock_after_push(s->deadlock, s->agent,
+                FLAT_ENTRY(push->box, 0), push->to))) {
+          mark_visited(s, hash, pushes + 1);
+          size_t child = record_child(s, id, push, player, hash,
+              s->unsolved);
+          if (s->unsolved == 0)
+            goal = child;
+          else
+            append_id(&next, &num_next, &next_size, child);
+        }
+        make_push(s, push, 1);
+      }
+    }
+    pushes++;
+    size_t *swap = layer;
+    layer = next;
+    next = swap;
+    size_t swap_size = layer_size;
+    layer_size = next_size;
+    next_size = swap_size;
+    num_layer = num_next;
+    num_next = 0;
+  }
+
+DONE:
+  free(layer);
+  free(next);
+  return goal;
+}
+
+/* Open states waiting to be expanded, by their pushes so far plus the
+   matching's estimate of the pushes left. */
+typedef struct {
+  size_t *ids;
+  size_t num;
+  size_t size;
+} Bucket;
+
+static void open_state(Bucket **open, size_t *num_buckets, uint32_t f,
+    size_t id) {
+  if (f >= *num_buckets) {
+    size_t n = *num_buckets;
+    while (n <= f)
+      n *= 2;
+    *open = realloc(*open, n * sizeof(Bucket));
+    memset(*open + *num_buckets, 0, (n - *num_buckets) * sizeof(Bucket));
+    *num_buckets = n;
+  }
+  Bucket *b = &(*open)[f];
+  append_id(&b->ids, &b->num, &b->size, id);
+}
+
+/* One side of search_bidirectional. */
+typedef struct {
+  IdTable *ids; /* state hash -> id, for every state the side has reached */
+  size_t *layer;
+  size_t num_layer;
+  size_t layer_size;
+  uint32_t pushes; /* of the states in layer */
+  int pulls; /* searching backward */
+} Side;
+
+static void side_add(Search *s, Side *side, size_t id) {
+  idtable_store(side->ids, STATE(s, id)->hash, id);
+  append_id(&side->layer, &side->num_layer, &side->layer_size, id);
+}
+
+/* The backward search starts from every position with all the boxes on
+   targets, one for each region the player could be left in. */
+static void add_goals(Search *s, Side *side) {
+  const FlatGraph *f = s->flat;
+  char *agent = malloc(f->num_tiles);
+  char *covered = calloc(f->num_tiles, 1);
+  uint64_t hash = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    agent[t] = f->tile_type[t] == TILE_TYPE_TARGET ? AGENT_BOX : AGENT_NONE;
+    if (agent[t] == AGENT_BOX)
+      hash ^= ZOBRIST_BOX(t);
+  }
+  memcpy(s->agent, agent, f->num_tiles);
+
+  for (uint32_t t = 0; t < f->num_tiles; t++) {
+    if (covered[t] || agent[t] == AGENT_BOX ||
+        f->tile_type[t] == TILE_TYPE_WALL)
+      continue;
+    uint32_t least = pushes_flood(s->pushes, agent, t);
+    size_t n;
+    const uint32_t *region = pushes_region(s->pushes, &n);
+    for (size_t i = 0; i < n; i++)
+      covered[region[i]] = 1;
+    size_t id = new_state(s);
+    snapshot(s, id);
+    StateHeader *h = STATE(s, id);
+    h->hash = hash ^ ZOBRIST_PLAYER(least);
+    h->parent = NO_STATE;
+    h->pushes = 0;
+    h->player = least;
+    h->unsolved = 0;
+    side_add(s, side, id);
+  }
+
+  free(agent);
+  free(covered);
+}
+
+/* Expand the whole of one side's layer.  Returns the cheapest meeting with
+   the other side found, as the forward state and the backward one. */
+static uint32_t expand_side(Search *s, Side *side, Side *other,
+    size_t *forward, size_t *back, const SolverParams *params,
+    SolverResult *result) {
+  size_t num_next = 0, next_size = 64;
+  size_t *next = malloc(next_size * sizeof(size_t));
+  uint32_t best = UINT32_MAX;
+
+  for (size_t i = 0; i < side->num_layer; i++) {
+    if (result->nodes_expanded >= params->max_nodes) {
+      result->status = SOLVER_LIMIT;
+      break;
+    }
+    size_t id = side->layer[i];
+    restore(s, id);
+    result->nodes_expanded++;
+    pushes_flood(s->pushes, s->agent, STATE(s, id)->player);
+    size_t num_pushes;
+    const Push *list = side->pulls ?
+      pushes_list_pulls(s->pushes, s->agent, &num_pushes) :
+      pushes_list(s->pushes, s->agent, &num_pushes);
+    for (size_t j = 0; j < num_pushes; j++) {
+      const Push *push = &list[j];
+      result->nodes_generated++;
+      make_push(s, push, side->pulls);
+      uint32_t player = pushes_flood(s->pushes, s->agent,
+          side->pulls ? push->tile : push->box);
+      uint64_t hash = state_hash(s, player);
+      size_t found;
+      if (!idtable_probe(side->ids, hash, &found) && !(!side->pulls &&
+            s->unsolved && deadlock_after_push(s->deadlock, s->agent,
+              FLAT_ENTRY(push->box, 0), push->to))) {
+        /* record_child moves a box from push->box to push->to, so a pull
+           has to be turned round; the player's side of it is kept, which
+           is what the solution needs either way */
+        Push moved = *push;
+        if (side->pulls) {
+          moved.box = push->to;
+          moved.to = push->box;
+        }
+        size_t child = record_child(s, id, &moved, player, hash, s->unsolved);
+        idtable_store(side->ids, hash, child);
+        append_id(&next, &num_next, &next_size, child);
+        if (idtable_probe(other->ids, hash, &found) &&
+            side->pushes + 1 + STATE(s, found)->pushes < best) {
+          best = side->pushes + 1 + STATE(s, found)->pushes;
+          *forward = side->pulls ? found : child;
+          *back = side->pulls ? child : found;
+        }
+      }
+      make_push(s, push, !side->pulls);
+    }
+  }
+
+  free(side->layer);
+  side->layer = next;
+  side->num_layer = num_next;
+  side->layer_size = next_size;
+  side->pushes++;
+  return best;
+}
+
+/* Breadth-first from both ends at once: forward by pushes from the board,
+   and backward by pulls from the goals, a layer at a time on whichever side
+   has the smaller layer.  Each side keeps a table from state to id, and
+   the first layer to reach a state the other side has seen gives the
+   shortest solution, taking the cheapest of the meetings it makes.  The
+   tables never drop a state, unlike the transposition table, since a
+   meeting missed would make the solution found longer.  Only
+   used when there are as many boxes as targets, so that the goals are
+   known; otherwise this is search_bfs. */
+static size_t search_bidirectional(Search *s, const SolverParams *params,
+    SolverResult *result, size_t *back) {
+  const FlatGraph *f = s->flat;
+  size_t boxes = 0, targets = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    boxes += f->agent[t] == AGENT_BOX;
+    targets += f->tile_type[t] == TILE_TYPE_TARGET;
+  }
+  if (boxes != targets || STATE(s, 0)->unsolved == 0)
+    return search_bfs(s, params, result);
+
+  Side sides[2];
+  memset(sides, 0, sizeof(sides));
+  sides[0].ids = new_idtable();
+  sides[1].ids = new_idtable();
+  sides[1].pulls = 1;
+  side_add(s, &sides[0], 0);
+  add_goals(s, &sides[1]);
+
+  size_t goal = NO_STATE;
+  size_t found;
+  result->status = SOLVER_UNSOLVABLE;
+  if (idtable_probe(sides[1].ids, STATE(s, 0)->hash, &found)) {
+    goal = 0;
+    *back = found;
+  }
+  while (goal == NO_STATE && result->status != SOLVER_LIMIT &&
+         sides[0].num_layer && sides[1].num_layer) {
+    int i = sides[1].num_layer < sides[0].num_layer;
+    size_t forward;
+    if (expand_side(s, &sides[i], &sides[!i], &forward, back, params,
+          result) != UINT32_MAX) {
+      goal = forward;
+    }
+  }
+
+  for (int i = 0; i < 2; i++) {
+    free(sides[i].layer);
+    free_idtable(sides[i].ids);
+  }
+  return goal;
+}
+
+/* Find the pushes from state id that lead to states not yet seen and not
+   known to be lost, and add them to s->children.  The table is only read,
+   so threads can expand side by side.  Returns how many pushes there
+   were. */
+static size_t expand(Search *s, size_t id) {
+  uint32_t pushes = STATE(s, id)->pushes;
+  restore(s, id);
+  /* Each push below is one update to the matching the state was stored
+     with, which is kept for the child in turn */
+  matching_unpack(s->matching, PACKED(s, id));
+  matching_save(s->matching);
+  pushes_flood(s->pushes, s->agent, STATE(s, id)->player);
+  size_t num_pushes;
+  const Push *list = pushes_list(s->pushes, s->agent, &num_pushes);
+  for (size_t j = 0; j < num_pushes; j++) {
+    const Push *push = &list[j];
+    make_push(s, push, 0);
+    uint32_t player = pushes_flood(s->pushes, s->agent, push->box);
+    uint64_t hash = state_hash(s, player);
+    if (!seen(s, hash, pushes + 1)) {
+      uint32_t estimate = matching_move(s->matching, push->box, push->to);
+      if (estimate != MATCHING_NONE && !(s->unsolved &&
+            deadlock_after_push(s->deadlock, s->agent,
+              FLAT_ENTRY(push->box, 0), push->to))) {
+        if (s->num_children == s->children_size) {
+          s->children_size = s->children_size ? 2 * s->children_size : 64;
+          s->children = realloc(s->children,
+              s->children_size * sizeof(Child));
+          s->child_matchings = realloc(s->child_matchings,
+              s->children_size * s->matching_size);
+        }
+        matching_pack(s->matching,
+            s->child_matchings + s->num_children * s->matching_size);
+        Child *c = &s->children[s->num_children++];
+        c->push = *push;
+        c->parent = id;
+        c->hash = hash;
+        c->player = player;
+        c->pushes = pushes + 1;
+        c->estimate = estimate;
+        c->unsolved = s->unsolved;
+        c->keep = 1;
+      }
+      matching_restore(s->matching);
+    }
+    make_push(s, push, 1);
+  }
+  return num_pushes;
+}
+
+/* Whether state id has since been reached with fewer pushes. */
+static int stale(Search *s, size_t id) {
+  uint32_t best;
+  return ttable_probe(s->visited, STATE(s, id)->hash, &best) &&
+    best < STATE(s, id)->pushes;
+}
+
+/* Store the children that were kept, with their matchings, and queue them
+   up. */
+static void open_children(Search *s, const Child *children,
+    const unsigned char *matchings, size_t n, Bucket **open,
+    size_t *num_buckets, size_t *num_open) {
+  for (size_t i = 0; i < n; i++) {
+    const Child *c = &children[i];
+    if (!c->keep)
+      continue;
+    size_t id = record_child(s, c->parent, &c->push, c->player, c->hash,
+        c->unsolved);
+    memcpy(PACKED(s, id), matchings + i * s->matching_size,
+        s->matching_size);
+    open_state(open, num_buckets, c->pushes + c->estimate, id);
+    (*num_open)++;
+  }
+}
+
+/* One round of search_astar. */
+typedef struct {
+  Search *workers;
+  size_t threads;
+  const size_t *ids; /* the states to expand */
+  size_t *owner; /* which worker expanded each */
+  size_t *first; /* where its children start in the owner's list */
+  size_t *count; /* and how many there are */
+  size_t *offset; /* where they go in children */
+  size_t *generated; /* by each worker */
+  Child *children;
+  unsigned char *matchings; /* packed, one for each child */
+  size_t num_children;
+} Round;
+
+static void round_expand(void *arg, size_t thread, size_t i) {
+  Round *r = arg;
+  Search *w = &r->workers[thread];
+  r->owner[i] = thread;
+  r->first[i] = w->num_children;
+  r->generated[thread] += expand(w, r->ids[i]);
+  r->count[i] = w->num_children - r->first[i];
+}
+
+static void round_gather(void *arg, size_t thread, size_t i) {
+  Round *r = arg;
+  Search *w = &r->workers[r->owner[i]];
+  memcpy(r->children + r->offset[i], w->children + r->first[i],
+      r->count[i] * sizeof(Child));
+  memcpy(r->matchings + r->offset[i] * w->matching_size,
+      w->child_matchings + r->first[i] * w->matching_size,
+      r->count[i] * w->matching_size);
+}
+
+/* Each thread stores the children in its own shard of the table, in the
+   same order as a single thread would. */
+static void round_store(void *arg, size_t thread) {
+  Round *r = arg;
+  Search *w = &r->workers[thread];
+  for (size_t i = 0; i < r->num_children; i++) {
+    Child *c = &r->children[i];
+    if (ttable_shard(w->visited, c->hash, r->threads) != thread)
+      continue;
+    c->keep = !seen(w, c->hash, c->pushes);
+    if (c->keep)
+      mark_visited(w, c->hash, c->pushes);
+  }
+}
+
+/* A* by number of pushes, guided by the matching.  A push changes one
+   box's distance to any target by at most one, so the estimate never
+   drops by more than the push costs and a state is first expanded with as
+   few pushes as it can be reached with.
+
+   The search goes in rounds.  Each round expands all the deepest open
+   states with the least estimate at once, shared out between threads,
+   each with its own copy of the boxes and its own scratch space.  Only the
+   expanding reads the table; the children are then put in a fixed order
+   and stored shard by shard, and states are numbered in that order.  So
+   what is found depends only on the level, however many threads there are
+   and however they are scheduled. */
+static size_t search_astar(Search *s, const SolverParams *params,
+    SolverResult *result) {
+  size_t threads = params->threads ? params->threads : 1;
+  Workers *pool = new_workers(threads);
+  Round r;
+  memset(&r, 0, sizeof(Round));
+  r.threads = threads;
+  r.workers = malloc(threads * sizeof(Search));
+  r.generated = malloc(threads * sizeof(size_t));
+  for (size_t t = 0; t < threads; t++) {
+    Search *w = &r.workers[t];
+    *w = *s;
+    if (t > 0) {
+      w->deadlock = new_deadlock(s->board);
+      w->pushes = new_pushes(s->board);
+      w->matching = matching_share(s->matching);
+      w->agent = malloc(s->flat->num_tiles);
+      if (s->symmetry)
+        w->keys = malloc(symmetry_count(s->symmetry) * sizeof(uint64_t));
+    }
+  }
+
+  size_t num_buckets = 64;
+  Bucket *open = calloc(num_buckets, sizeof(Bucket));
+  size_t num_open = 0;
+  size_t goal = NO_STATE;
+  size_t children_size = 0;
+  size_t *ids = NULL;
+
+  result->status = SOLVER_UNSOLVABLE;
+  /* The only matching solved from scratch */
+  uint32_t estimate = matching_reset(s->matching, s->agent);
+  if (estimate != MATCHING_NONE) {
+    matching_pack(s->matching, PACKED(s, 0));
+    open_state(&open, &num_buckets, estimate, 0);
+    num_open++;
+    mark_visited(s, STATE(s, 0)->hash, 0);
+  }
+
+  for (uint32_t f = estimate; num_open; ) {
+    if (open[f].num == 0) {
+      f++;
+      continue;
+    }
+    /* Take the deepest states of the bucket, keeping the rest in order */
+    Bucket *b = &open[f];
+    uint32_t deepest = 0;
+    size_t kept = 0, n = 0;
+    for (size_t i = 0; i < b->num; i++) {
+      if (stale(s, b->ids[i]))
+        continue;
+      b->ids[kept++] = b->ids[i];
+      if (STATE(s, b->ids[i])->pushes > deepest)
+        deepest = STATE(s, b->ids[i])->pushes;
+    }
+    num_open -= b->num - kept;
+    if (kept)
+      ids = realloc(ids, kept * sizeof(size_t));
+    b->num = 0;
+    for (size_t i = 0; i < kept; i++) {
+      if (STATE(s, b->ids[i])->pushes == deepest)
+        ids[n++] = b->ids[i];
+      else
+        b->ids[b->num++] = b->ids[i];
+    }
+    num_open -= n;
+    for (size_t i = 0; i < n && goal == NO_STATE; i++) {
+      if (STATE(s, ids[i])->unsolved == 0)
+        goal = ids[i];
+    }
+    if (goal == NO_STATE && result->nodes_expanded >= params->max_nodes)
+      result->status = SOLVER_LIMIT;
+    if (goal != NO_STATE || result->status == SOLVER_LIMIT)
+      break;
+    result->nodes_expanded += n;
+
+    r.ids = ids;
+    r.owner = realloc(r.owner, n * sizeof(size_t));
+    r.first = realloc(r.first, n * sizeof(size_t));
+    r.count = realloc(r.count, n * sizeof(size_t));
+    r.offset = realloc(r.offset, n * sizeof(size_t));
+    for (size_t t = 0; t < threads; t++) {
+      /* Storing children may have moved the states */
+      r.workers[t].states = s->states;
+      r.workers[t].num_children = 0;
+      r.generated[t] = 0;
+    }
+    workers_for(pool, n, round_expand, &r);
+
+    r.num_children = 0;
+    for (size_t i = 0; i < n; i++) {
+      r.offset[i] = r.num_children;
+      r.num_children += r.count[i];
+    }
+    if (r.num_children > children_size) {
+      children_size = r.num_children;
+      r.children = realloc(r.children, children_size * sizeof(Child));
+      r.matchings = realloc(r.matchings, children_size * s->matching_size);
+    }
+    workers_for(pool, n, round_gather, &r);
+    workers_each(pool, round_store, &r);
+    for (size_t t = 0; t < threads; t++)
+      result->nodes_generated += r.generated[t];
+
+    open_children(s, r.children, r.matchings, r.num_children, &open,
+        &num_buckets, &num_open);
+  }
+
+  for (size_t t = 0; t < threads; t++) {
+    Search *w = &r.workers[t];
+    if (t > 0) {
+      free_deadlock(w->deadlock);
+      free_pushes(w->pushes);
+      free_matching(w->matching);
+      free(w->agent);
+      free(w->keys);
+    }
+    free(w->children);
+    free(w->child_matchings);
+  }
+  free_workers(pool);
+  free(r.workers);
+  free(r.generated);
+  free(r.owner);
+  free(r.first);
+  free(r.count);
+  free(r.offset);
+  free(r.children);
+  free(r.matchings);
+  free(ids);
+  for (size_t i = 0; i < num_buckets; i++)
+    free(open[i].ids);
+  free(open);
+  return goal;
+}
+
+SolverResult *solve_board(Board *board, const SolverParams *params) {
+  if (params == NULL) {
+    params = &default_params;
+  }
+
+  SolverResult *result = calloc(1, sizeof(SolverResult));
+  double start = get_time();
+  TransTable *visited = new_ttable(params->table_size);
+  if (visited == NULL) {
+    result->status = SOLVER_NO_MEMORY;
+    return result;
+  }
+
+  /* The search runs on a private copy of the board's state, so the board
+     itself is never touched. */
+  Search s;
+  memset(&s, 0, sizeof(Search));
+  s.board = board;
+  s.flat = board->flat;
+  s.words = (s.flat->num_tiles + 63) / 64;
+  s.matching = params->algorithm == SOLVER_ASTAR ? new_matching(board) : NULL;
+  s.matching_size = s.matching ? matching_packed_size(s.matching) : 0;
+  s.stride = sizeof(StateHeader) + s.words * sizeof(uint64_t) +
+    s.matching_size;
+  s.states_size = 1024;
+  s.states = malloc(s.states_size * s.stride);
+  s.visited = visited;
+  s.deadlock = new_deadlock(board);
+  s.pushes = new_pushes(board);
+  /* Meeting in the middle needs both sides to agree on the very state */
+  if (params->algorithm != SOLVER_BIDIRECTIONAL)
+    s.symmetry = new_symmetry(board);
+  s.agent = malloc(s.flat->num_tiles);
+  memcpy(s.agent, s.flat->agent, s.flat->num_tiles);
+  s.unsolved = board->unsolved;
+  s.hash = board->hash ^ ZOBRIST_PLAYER(FLAT_TILE(board->player));
+  if (s.symmetry) {
+    s.keys = malloc(symmetry_count(s.symmetry) * sizeof(uint64_t));
+    symmetry_boxes(s.symmetry, s.agent, s.keys);
+  }
+
+  size_t root = new_state(&s);
+  snapshot(&s, root);
+  StateHeader *h = STATE(&s, root);
+  h->parent = NO_STATE;
+  h->pushes = 0;
+  h->player = pushes_flood(s.pushes, s.agent, FLAT_TILE(board->player));
+  h->hash = state_hash(&s, h->player);
+  h->unsolved = board->unsolved;
+
+  size_t goal, back = NO_STATE;
+  if (params->algorithm == SOLVER_BIDIRECTIONAL)
+    goal = search_bidirectional(&s, params, result, &back);
+  else if (params->algorithm == SOLVER_BFS)
+    goal = search_bfs(&s, params, result);
+  else
+    goal = search_astar(&s, params, result);
+  if (goal != NO_STATE) {
+    result->status = SOLVER_SOLVED;
+    result->solution = extract_solution(&s, goal, back, &result->moves);
+    for (char *c = result->solution; *c; c++) {
+      if (*c >= 'A' && *c <= 'Z')
+        result->pushes++;
+    }
+  }
+
+  free(s.agent);
+  free(s.states);
+  free_ttable(s.visited);
+  free_deadlock(s.deadlock);
+  free_pushes(s.pushes);
+  if (s.matching)
+    free_matching(s.matching);
+  if (s.symmetry)
+    free_symmetry(s.symmetry);
+  free(s.keys);
+
+  result->seconds = get_time() - start;
+  return result;
+}
+
+void free_solver_result(SolverResult *result) {
+  free(result->solution);
+  free(result);
+}
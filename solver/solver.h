@@ -0,0 +1,70 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__SOLVER_H
+#define __HYPERBAN__SOLVER_H
+
+#include <stddef.h>
+
+#include "../graph/types.h"
+
+typedef enum {
+  SOLVER_BFS = 0, /* breadth-first, by pushes */
+  SOLVER_ASTAR = 1, /* A*, estimating the pushes left; see matching.h */
+  SOLVER_BIDIRECTIONAL = 2, /* breadth-first from the goals too, by pulls */
+} solver_algorithm_t;
+
+struct solver_params_t {
+  size_t max_nodes; /* give up after expanding this many states */
+  size_t table_size; /* bytes of transposition table */
+  solver_algorithm_t algorithm;
+  size_t threads; /* for A*, which finds the same whatever this is */
+};
+
+typedef struct solver_params_t SolverParams;
+
+typedef enum {
+  SOLVER_SOLVED = 0,
+  SOLVER_UNSOLVABLE = 1, /* the whole state space was searched */
+  SOLVER_LIMIT = 2, /* max_nodes was hit first */
+  SOLVER_NO_MEMORY = 3, /* the table could not be allocated */
+} solver_status_t;
+
+typedef struct {
+  solver_status_t status;
+  char *solution; /* LURD string as recorded by perform_move, or NULL */
+  size_t pushes;
+  size_t moves;
+  size_t nodes_expanded;
+  size_t nodes_generated;
+  double seconds;
+} SolverResult;
+
+/* Search for a push-optimal solution to board, starting from its current
+   position.  The board is not modified. */
+SolverResult *solve_board(Board *board, const SolverParams *params);
+
+void free_solver_result(SolverResult *result);
+
+#define SOLVER_DEFAULT_MAX_NODES 2000000
+#define SOLVER_DEFAULT_TABLE_SIZE (64 << 20)
+#define SOLVER_DEFAULT_THREADS 1
+
+#endif /* __HYPERBAN__SOLVER_H */
@@ -0,0 +1,234 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "symmetry.h"
+
+#include <stdlib.h>
+
+#include "../graph/flat.h"
+#include "../graph/zobrist.h"
+
+#define UNMAPPED UINT32_MAX
+
+struct symmetry_t {
+  size_t num_tiles;
+  size_t count;
+  uint32_t *map; /* count * num_tiles: where each floor tile goes */
+};
+
+static int blocked(const FlatGraph *f, uint32_t entry) {
+  return entry == FLAT_NONE || f->tile_type[FLAT_TILE(entry)] == TILE_TYPE_WALL;
+}
+
+/* Try to map tile 0 to tile image, turning edge d to edge turn + sign * d.
+   The rest of the floor follows from that, if it fits at all.  map comes in
+   all UNMAPPED, and goes back that way if it doesn't fit; only the tiles
+   reached so far, the ones in queue, need undoing.  turns holds the turn for
+   each of them, and hit is all zero, and left that way. */
+static int extend(const FlatGraph *f, uint32_t image, int turn, int sign,
+    size_t num_floor, uint32_t *map, int *turns, uint32_t *queue, char *hit) {
+  size_t head = 0, tail = 0, i = 0;
+  map[0] = image;
+  turns[0] = turn;
+  queue[tail++] = 0;
+  while (head < tail) {
+    uint32_t u = queue[head++];
+    if (f->tile_type[u] != f->tile_type[map[u]])
+      goto undo;
+    for (int d = 0; d < 4; d++) {
+      uint32_t n = f->neighbor[4 * u + d];
+      uint32_t m = f->neighbor[4 * map[u] + ((turns[u] + sign * d) & 3)];
+      if (blocked(f, n) || blocked(f, m)) {
+        if (blocked(f, n) != blocked(f, m))
+          goto undo;
+        continue;
+      }
+      /* n faces back at u, and m at map[u], so their orientations are the
+         edges that have to correspond */
+      uint32_t v = FLAT_TILE(n);
+      int t = (FLAT_ORIENTATION(m) - sign * FLAT_ORIENTATION(n)) & 3;
+      if (map[v] == UNMAPPED) {
+        map[v] = FLAT_TILE(m);
+        turns[v] = t;
+        queue[tail++] = v;
+      } else if (map[v] != FLAT_TILE(m) || turns[v] != t) {
+        goto undo;
+      }
+    }
+  }
+  /* A map that missed some floor, or folded it, isn't one */
+  if (tail != num_floor)
+    goto undo;
+  for (; i < tail; i++) {
+    if (hit[map[queue[i]]])
+      break;
+    hit[map[queue[i]]] = 1;
+  }
+  for (size_t j = 0; j < i; j++)
+    hit[map[queue[j]]] = 0;
+  if (i < tail)
+    goto undo;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    if (map[t] == UNMAPPED)
+      map[t] = t;
+  }
+  return 1;
+
+undo:
+  for (size_t j = 0; j < tail; j++)
+    map[queue[j]] = UNMAPPED;
+  return 0;
+}
+
+/* Whether tile image has walls, or the edge of the level, on the sides
+   tile 0's are on, once turned as extend would. */
+static int fits(const FlatGraph *f, uint32_t image, int turn, int sign) {
+  for (int d = 0; d < 4; d++) {
+    if (blocked(f, f->neighbor[d])
+        != blocked(f, f->neighbor[4 * image + ((turn + sign * d) & 3)]))
+      return 0;
+  }
+  return 1;
+}
+
+/* How far each floor tile is from the nearest target, in steps over floor,
+   or UINT32_MAX if none can be reached.  A symmetry keeps targets and the
+   way tiles meet, so it keeps this too, and can only send tile 0 to a tile
+   as far away as it is.  queue is scratch. */
+static uint32_t *target_distances(const FlatGraph *f, uint32_t *queue) {
+  uint32_t *dist = malloc(f->num_tiles * sizeof(uint32_t));
+  size_t head = 0, tail = 0;
+  for (size_t t = 0; t < f->num_tiles; t++) {
+    dist[t] = UINT32_MAX;
+    if (f->tile_type[t] == TILE_TYPE_TARGET) {
+      dist[t] = 0;
+      queue[tail++] = t;
+    }
+  }
+  while (head < tail) {
+    uint32_t u = queue[head++];
+    for (int d = 0; d < 4; d++) {
+      uint32_t n = f->neighbor[4 * u + d];
+      if (!blocked(f, n) && dist[FLAT_TILE(n)] == UINT32_MAX) {
+        dist[FLAT_TILE(n)] = dist[u] + 1;
+        queue[tail++] = FLAT_TILE(n);
+      }
+    }
+  }
+  return dist;
+}
+
+Symmetry *new_symmetry(const Board *board) {
+  const FlatGraph *f = board->flat;
+  size_t n = f->num_tiles;
+  Symmetry *sym = malloc(sizeof(Symmetry));
+  sym->num_tiles = n;
+  sym->count = 0;
+  size_t size = 8;
+  sym->map = malloc(size * n * sizeof(uint32_t));
+  int *turns = malloc(n * sizeof(int));
+  uint32_t *queue = malloc(n * sizeof(uint32_t));
+  char *hit = calloc(n, 1);
+  size_t num_floor = 0, num_boxes = 0;
+  for (size_t t = 0; t < n; t++) {
+    num_floor += f->tile_type[t] != TILE_TYPE_WALL;
+    num_boxes += f->agent[t] == AGENT_BOX;
+  }
+
+  /* Tile 0 is where the player starts, so it is floor.  The identity is
+     the first map tried.  With one box there are too few positions for the
+     maps to save what finding them costs. */
+  if (f->tile_type[0] != TILE_TYPE_WALL && num_boxes > 1) {
+    uint32_t *dist = target_distances(f, queue);
+    uint32_t *map = sym->map;
+    for (size_t t = 0; t < n; t++)
+      map[t] = UNMAPPED;
+    for (uint32_t image = 0; image < n; image++) {
+      if (f->tile_type[image] != f->tile_type[0] || dist[image] != dist[0])
+        continue;
+      for (int i = 0; i < 8; i++) {
+        int turn = i / 2, sign = i % 2 ? -1 : 1;
+        if (!fits(f, image, turn, sign)
+            || !extend(f, image, turn, sign, num_floor, map, turns, queue,
+                       hit))
+          continue;
+        if (++sym->count == size) {
+          size *= 2;
+          sym->map = realloc(sym->map, size * n * sizeof(uint32_t));
+        }
+        map = sym->map + sym->count * n;
+        for (size_t t = 0; t < n; t++)
+          map[t] = UNMAPPED;
+      }
+    }
+    free(dist);
+  }
+
+  free(turns);
+  free(queue);
+  free(hit);
+  if (sym->count <= 1) {
+    free_symmetry(sym);
+    return NULL;
+  }
+  return sym;
+}
+
+void free_symmetry(Symmetry *sym) {
+  free(sym->map);
+  free(sym);
+}
+
+size_t symmetry_count(const Symmetry *sym) {
+  return sym->count;
+}
+
+void symmetry_boxes(const Symmetry *sym, const char *agent, uint64_t *keys) {
+  for (size_t i = 0; i < sym->count; i++) {
+    const uint32_t *map = sym->map + i * sym->num_tiles;
+    keys[i] = 0;
+    for (size_t t = 0; t < sym->num_tiles; t++) {
+      if (agent[t] == AGENT_BOX)
+        keys[i] ^= ZOBRIST_BOX(map[t]);
+    }
+  }
+}
+
+void symmetry_move(const Symmetry *sym, uint64_t *keys, uint32_t from,
+    uint32_t to) {
+  for (size_t i = 0; i < sym->count; i++) {
+    const uint32_t *map = sym->map + i * sym->num_tiles;
+    keys[i] ^= ZOBRIST_BOX(map[from]) ^ ZOBRIST_BOX(map[to]);
+  }
+}
+
+uint64_t symmetry_hash(const Symmetry *sym, const uint64_t *keys,
+    const uint32_t *region, size_t n) {
+  uint64_t best = UINT64_MAX;
+  for (size_t i = 0; i < sym->count; i++) {
+    const uint32_t *map = sym->map + i * sym->num_tiles;
+    uint32_t least = UINT32_MAX;
+    for (size_t j = 0; j < n; j++)
+      least = map[region[j]] < least ? map[region[j]] : least;
+    uint64_t hash = keys[i] ^ ZOBRIST_PLAYER(least);
+    best = hash < best ? hash : best;
+  }
+  return best;
+}
@@ -0,0 +1,56 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__SYMMETRY_H
+#define __HYPERBAN__SYMMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../graph/types.h"
+
+/* The symmetries of a level: maps of its floor onto itself that turn or
+   mirror every tile the same way, and keep targets, walls and the way the
+   tiles meet.  A position and its image under one need the same pushes, so
+   a search only has to see one of them.  Where the boxes and player start
+   plays no part. */
+
+typedef struct symmetry_t Symmetry;
+
+/* Returns NULL if the identity is the only symmetry. */
+Symmetry *new_symmetry (const Board *board);
+void free_symmetry (Symmetry *sym);
+
+/* How many there are, the identity first. */
+size_t symmetry_count (const Symmetry *sym);
+
+/* The Zobrist keys of the boxes in agent under each symmetry. */
+void symmetry_boxes (const Symmetry *sym, const char *agent, uint64_t *keys);
+
+/* A box has moved from tile from to tile to; bring keys up to date. */
+void symmetry_move (const Symmetry *sym, uint64_t *keys, uint32_t from,
+                    uint32_t to);
+
+/* The hash a position shares with all its images: the least of theirs.
+   keys are the boxes' as above, and region is the player's. */
+uint64_t symmetry_hash (const Symmetry *sym, const uint64_t *keys,
+                        const uint32_t *region, size_t n);
+
+#endif /* __HYPERBAN__SYMMETRY_H */
@@ -0,0 +1,140 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "table.h"
+
+#include <stdlib.h>
+
+/* Key 0 marks an empty entry, so a real key of 0 is stored as 1. */
+#define STORED_KEY(k) ((k) ? (k) : 1)
+
+TransTable *new_ttable(size_t bytes) {
+  size_t buckets = 1;
+  while (buckets * 2 * TABLE_BUCKET_SIZE * sizeof(TableEntry) <= bytes)
+    buckets *= 2;
+
+  TransTable *table = malloc(sizeof(TransTable));
+  table->mask = buckets - 1;
+  table->entries = calloc(buckets * TABLE_BUCKET_SIZE, sizeof(TableEntry));
+  if (table->entries == NULL) {
+    free(table);
+    return NULL;
+  }
+  return table;
+}
+
+void free_ttable(TransTable *table) {
+  free(table->entries);
+  free(table);
+}
+
+int ttable_probe(const TransTable *table, uint64_t key, uint32_t *value) {
+  key = STORED_KEY(key);
+  const TableEntry *bucket =
+      table->entries + (key & table->mask) * TABLE_BUCKET_SIZE;
+  for (size_t i = 0; i < TABLE_BUCKET_SIZE; i++) {
+    if (bucket[i].key == key) {
+      *value = bucket[i].value;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+size_t ttable_shard(const TransTable *table, uint64_t key, size_t shards) {
+  return (STORED_KEY(key) & table->mask) % shards;
+}
+
+void ttable_store(TransTable *table, uint64_t key, uint32_t value,
+    uint32_t priority) {
+  key = STORED_KEY(key);
+  TableEntry *bucket =
+      table->entries + (key & table->mask) * TABLE_BUCKET_SIZE;
+  TableEntry *victim = bucket;
+  for (size_t i = 0; i < TABLE_BUCKET_SIZE; i++) {
+    if (bucket[i].key == key || bucket[i].key == 0) {
+      victim = &bucket[i];
+      break;
+    }
+    if (bucket[i].priority < victim->priority)
+      victim = &bucket[i];
+  }
+  victim->key = key;
+  victim->value = value;
+  victim->priority = priority;
+}
+
+#define IDTABLE_MIN_SIZE 1024
+
+IdTable *new_idtable(void) {
+  IdTable *table = malloc(sizeof(IdTable));
+  table->mask = IDTABLE_MIN_SIZE - 1;
+  table->count = 0;
+  table->entries = calloc(IDTABLE_MIN_SIZE, sizeof(IdEntry));
+  return table;
+}
+
+void free_idtable(IdTable *table) {
+  free(table->entries);
+  free(table);
+}
+
+/* Where key is, or the empty entry it would go in; probing is linear. */
+static IdEntry *idtable_find(const IdTable *table, uint64_t key) {
+  size_t i = key & table->mask;
+  while (table->entries[i].key != key && table->entries[i].key != 0)
+    i = (i + 1) & table->mask;
+  return &table->entries[i];
+}
+
+int idtable_probe(const IdTable *table, uint64_t key, size_t *value) {
+  const IdEntry *e = idtable_find(table, STORED_KEY(key));
+  if (e->key == 0)
+    return 0;
+  *value = e->value;
+  return 1;
+}
+
+/* Kept at most half full, so probes stay short. */
+static void idtable_grow(IdTable *table) {
+  IdEntry *old = table->entries;
+  size_t size = table->mask + 1;
+  table->mask = 2 * size - 1;
+  table->entries = calloc(2 * size, sizeof(IdEntry));
+  for (size_t i = 0; i < size; i++) {
+    if (old[i].key)
+      *idtable_find(table, old[i].key) = old[i];
+  }
+  free(old);
+}
+
+void idtable_store(IdTable *table, uint64_t key, size_t value) {
+  key = STORED_KEY(key);
+  IdEntry *e = idtable_find(table, key);
+  if (e->key == 0) {
+    if (2 * (table->count + 1) > table->mask + 1) {
+      idtable_grow(table);
+      e = idtable_find(table, key);
+    }
+    table->count++;
+    e->key = key;
+  }
+  e->value = value;
+}
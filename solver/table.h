@@ -0,0 +1,81 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__TABLE_H
+#define __HYPERBAN__TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A fixed-size transposition table keyed on Board.hash.  It never grows:
+   when a bucket is full, the entry with the lowest priority is replaced, so
+   a probe can miss a state that was stored long ago. */
+
+typedef struct {
+  uint64_t key;
+  uint32_t value;
+  uint32_t priority;
+} TableEntry;
+
+/* Four entries make one cache line. */
+#define TABLE_BUCKET_SIZE 4
+
+typedef struct {
+  TableEntry *entries;
+  size_t mask; /* number of buckets - 1 */
+} TransTable;
+
+/* bytes is rounded down to a power of two number of buckets. */
+TransTable *new_ttable (size_t bytes);
+void free_ttable (TransTable *table);
+
+/* Returns 1 and fills in value if key is present. */
+int ttable_probe (const TransTable *table, uint64_t key, uint32_t *value);
+void ttable_store (TransTable *table, uint64_t key, uint32_t value,
+                   uint32_t priority);
+
+/* Which of shards parts of the table key belongs to.  Keys in different
+   shards never share a bucket, so threads that each store only to their
+   own shards need no locks. */
+size_t ttable_shard (const TransTable *table, uint64_t key, size_t shards);
+
+/* A table that keeps every key it is given, growing as it fills, for
+   when a probe that misses would give a wrong answer rather than a slower
+   one.  Keys are still only hashes. */
+
+typedef struct {
+  uint64_t key;
+  size_t value; /* a state id, so as wide as one */
+} IdEntry;
+
+typedef struct {
+  IdEntry *entries;
+  size_t mask; /* number of entries - 1 */
+  size_t count;
+} IdTable;
+
+IdTable *new_idtable (void);
+void free_idtable (IdTable *table);
+
+/* Returns 1 and fills in value if key is present. */
+int idtable_probe (const IdTable *table, uint64_t key, size_t *value);
+void idtable_store (IdTable *table, uint64_t key, size_t value);
+
+#endif /* __HYPERBAN__TABLE_H */
@@ -0,0 +1,191 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "workers.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct {
+  pthread_mutex_t lock;
+  size_t next; /* the owner takes from here up */
+  size_t end; /* thieves take from here down */
+} Share;
+
+typedef struct {
+  Workers *w;
+  size_t thread;
+} Worker;
+
+struct workers_t {
+  size_t threads;
+  pthread_t *ids;
+  Worker *self;
+  Share *shares;
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  unsigned long round;
+  size_t running;
+  int quit;
+  /* the round, set by the caller before it starts */
+  void (*fn) (void *, size_t, size_t);
+  void (*each) (void *, size_t);
+  void *arg;
+};
+
+static int take(Workers *w, size_t thread, size_t *i) {
+  Share *own = &w->shares[thread];
+  pthread_mutex_lock(&own->lock);
+  int found = own->next < own->end;
+  if (found)
+    *i = own->next++;
+  pthread_mutex_unlock(&own->lock);
+  if (found)
+    return 1;
+
+  for (size_t k = 1; k < w->threads; k++) {
+    Share *victim = &w->shares[(thread + k) % w->threads];
+    pthread_mutex_lock(&victim->lock);
+    size_t left = victim->end - victim->next;
+    size_t lo = victim->end - (left + 1) / 2, hi = victim->end;
+    if (left)
+      victim->end = lo;
+    pthread_mutex_unlock(&victim->lock);
+    if (left) {
+      pthread_mutex_lock(&own->lock);
+      own->next = lo + 1;
+      own->end = hi;
+      pthread_mutex_unlock(&own->lock);
+      *i = lo;
+      return 1;
+    }
+  }
+  /* Nothing is ever added during a round, so this thread is done */
+  return 0;
+}
+
+static void run(Workers *w, size_t thread) {
+  if (w->each) {
+    w->each(w->arg, thread);
+    return;
+  }
+  size_t i;
+  while (take(w, thread, &i))
+    w->fn(w->arg, thread, i);
+}
+
+static void *worker_main(void *p) {
+  Worker *self = p;
+  Workers *w = self->w;
+  unsigned long round = 0;
+  pthread_mutex_lock(&w->lock);
+  for (;;) {
+    while (w->round == round && !w->quit)
+      pthread_cond_wait(&w->start, &w->lock);
+    if (w->quit)
+      break;
+    round = w->round;
+    pthread_mutex_unlock(&w->lock);
+    run(w, self->thread);
+    pthread_mutex_lock(&w->lock);
+    if (--w->running == 0)
+      pthread_cond_signal(&w->done);
+  }
+  pthread_mutex_unlock(&w->lock);
+  return NULL;
+}
+
+static void start(Workers *w) {
+  pthread_mutex_lock(&w->lock);
+  w->round++;
+  w->running = w->threads - 1;
+  pthread_cond_broadcast(&w->start);
+  pthread_mutex_unlock(&w->lock);
+
+  run(w, 0);
+
+  pthread_mutex_lock(&w->lock);
+  while (w->running)
+    pthread_cond_wait(&w->done, &w->lock);
+  pthread_mutex_unlock(&w->lock);
+}
+
+Workers *new_workers(size_t threads) {
+  Workers *w = malloc(sizeof(Workers));
+  w->threads = threads ? threads : 1;
+  w->ids = malloc(w->threads * sizeof(pthread_t));
+  w->self = malloc(w->threads * sizeof(Worker));
+  w->shares = malloc(w->threads * sizeof(Share));
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->start, NULL);
+  pthread_cond_init(&w->done, NULL);
+  w->round = 0;
+  w->running = 0;
+  w->quit = 0;
+  for (size_t t = 0; t < w->threads; t++) {
+    pthread_mutex_init(&w->shares[t].lock, NULL);
+    w->self[t].w = w;
+    w->self[t].thread = t;
+    if (t > 0)
+      pthread_create(&w->ids[t], NULL, worker_main, &w->self[t]);
+  }
+  return w;
+}
+
+void free_workers(Workers *w) {
+  pthread_mutex_lock(&w->lock);
+  w->quit = 1;
+  pthread_cond_broadcast(&w->start);
+  pthread_mutex_unlock(&w->lock);
+  for (size_t t = 0; t < w->threads; t++) {
+    if (t > 0)
+      pthread_join(w->ids[t], NULL);
+    pthread_mutex_destroy(&w->shares[t].lock);
+  }
+  pthread_mutex_destroy(&w->lock);
+  pthread_cond_destroy(&w->start);
+  pthread_cond_destroy(&w->done);
+  free(w->ids);
+  free(w->self);
+  free(w->shares);
+  free(w);
+}
+
+void workers_for(Workers *w, size_t n,
+    void (*fn) (void *arg, size_t thread, size_t i), void *arg) {
+  /* The threads are all waiting, and start() publishes this to them */
+  for (size_t t = 0; t < w->threads; t++) {
+    w->shares[t].next = n * t / w->threads;
+    w->shares[t].end = n * (t + 1) / w->threads;
+  }
+  w->fn = fn;
+  w->each = NULL;
+  w->arg = arg;
+  start(w);
+}
+
+void workers_each(Workers *w, void (*fn) (void *arg, size_t thread),
+    void *arg) {
+  w->fn = NULL;
+  w->each = fn;
+  w->arg = arg;
+  start(w);
+}
@@ -0,0 +1,46 @@
+/* Hyperban is an implementation of Sokoban on the hyperbolic plane.  Copyright
+ * (C) 2013 George Silvis, III <george.iii.silvis@gmail.com> and Allan Wirth
+ * <allan@allanwirth.com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERBAN__WORKERS_H
+#define __HYPERBAN__WORKERS_H
+
+#include <stddef.h>
+
+/* A pool of threads that take work in rounds.  A round is either a range
+   of indices, which starts out split evenly between the threads, each
+   working up from the bottom of its share; a thread that runs out steals
+   the top half of what another has left.  Or it is one call on each
+   thread.  Either way the caller's thread is thread 0, and the call
+   returns when the round is over. */
+
+typedef struct workers_t Workers;
+
+Workers *new_workers (size_t threads);
+void free_workers (Workers *w);
+
+/* Call fn(arg, thread, i) for every i below n. */
+void workers_for (Workers *w, size_t n,
+                  void (*fn) (void *arg, size_t thread, size_t i), void *arg);
+
+/* Call fn(arg, thread) once on every thread. */
+void workers_each (Workers *w, void (*fn) (void *arg, size_t thread),
+                   void *arg);
+
+#endif /* __HYPERBAN__WORKERS_H */